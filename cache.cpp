@@ -0,0 +1,192 @@
+// Copyright 2022 Joaquin M Lopez Munoz.
+// Distributed under the Boost Software License, Version 1.0.
+// https://www.boost.org/LICENSE_1_0.txt
+
+#include <boost/algorithm/minmax_element.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <vector>
+#include "container_defs.hpp"
+#include "foa_rc_cache.hpp"
+
+using namespace std::chrono_literals;
+
+static void print_time( std::chrono::steady_clock::time_point & t1, char const* label, std::uint64_t s, std::size_t size )
+{
+    auto t2 = std::chrono::steady_clock::now();
+
+    std::cout << label << ": " << ( t2 - t1 ) / 1ms << " ms (s=" << s << ", size=" << size << ")\n";
+
+    t1 = t2;
+}
+
+// Skewed access stream over N keys, 90% of the accesses going to a hot set
+// of N/10 keys, served through a cache holding about N/8 elements: a miss
+// looks the key up, then inserts it, evicting some other element if needed
+
+constexpr unsigned N = 2'000'000;
+constexpr int K = 10;
+
+static std::vector< std::uint64_t > keys, accesses;
+
+static void init_indices()
+{
+    boost::detail::splitmix64 rng;
+
+    for( unsigned i = 0; i < N; ++i )
+    {
+        keys.push_back( rng() );
+    }
+
+    for( unsigned i = 0; i < N * 2; ++i )
+    {
+        auto r = rng();
+        accesses.push_back( keys[ r % 10 != 0? r / 10 % ( N / 10 ): r / 10 % N ] );
+    }
+}
+
+// exact LRU over boost::unordered_flat_map and std::list, for reference
+
+template<class K, class V> class lru_cache
+{
+public:
+
+    explicit lru_cache( std::size_t capacity ): capacity_( capacity )
+    {
+        map_.reserve( capacity );
+    }
+
+    std::size_t size() const noexcept { return map_.size(); }
+    std::size_t capacity() const noexcept { return capacity_; }
+
+    V* find( K const& k )
+    {
+        auto it = map_.find( k );
+        if( it == map_.end() ) return nullptr;
+
+        list_.splice( list_.begin(), list_, it->second );
+        return &it->second->second;
+    }
+
+    bool insert_or_assign( K const& k, V const& v )
+    {
+        if( auto p = find( k ) )
+        {
+            *p = v;
+            return false;
+        }
+
+        if( map_.size() == capacity_ )
+        {
+            map_.erase( list_.back().first );
+            list_.pop_back();
+        }
+
+        list_.emplace_front( k, v );
+        map_.emplace( k, list_.begin() );
+        return true;
+    }
+
+private:
+
+    using list_type = std::list< std::pair<K, V> >;
+
+    std::size_t capacity_;
+    list_type list_;
+    boost::unordered_flat_map<K, typename list_type::iterator> map_;
+};
+
+template<class K, class V>
+using foa_mulx_rc15_cache =
+  fxa_unordered::rc::foa_rc_cache<K, V, mulx_hash<K>>;
+
+template<class Cache> void BOOST_NOINLINE test_access( Cache& cache, std::uint64_t& hits, std::chrono::steady_clock::time_point & t1 )
+{
+    std::uint64_t s = 0;
+
+    for( int j = 0; j < K; ++j )
+    {
+        for( auto k: accesses )
+        {
+            if( auto p = cache.find( k ) )
+            {
+                s += *p;
+                ++hits;
+            }
+            else cache.insert_or_assign( k, k );
+        }
+    }
+
+    print_time( t1, "Skewed access",  s, cache.size() );
+
+    std::cout << std::endl;
+}
+
+//
+
+struct record
+{
+    std::string label_;
+    long long time_;
+    double hit_ratio_;
+};
+
+static std::vector<record> times;
+
+template<class Cache> void BOOST_NOINLINE test( char const* label, std::size_t capacity )
+{
+    std::cout << label << ":\n\n";
+
+    Cache cache( capacity );
+    std::uint64_t hits = 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    auto t1 = t0;
+
+    test_access( cache, hits, t1 );
+
+    auto tN = std::chrono::steady_clock::now();
+    double hit_ratio = (double)hits / ( (double)K * accesses.size() );
+
+    std::cout << "Capacity: " << cache.capacity() << ", hit ratio: " << hit_ratio << "\n\n";
+    std::cout << "Total: " << ( tN - t0 ) / 1ms << " ms\n\n";
+
+    times.push_back( { label, ( tN - t0 ) / 1ms, hit_ratio } );
+}
+
+int main()
+{
+    init_indices();
+
+    // foa_rc_cache rounds capacity up to its group layout, the LRU gets the same
+    using rc_cache = foa_mulx_rc15_cache<std::uint64_t, std::uint64_t>;
+    std::size_t capacity = rc_cache( N / 8 ).capacity();
+
+    test< lru_cache<std::uint64_t, std::uint64_t> >( "LRU (boost::unordered_flat_map+std::list)", capacity );
+    test< rc_cache >( "foa_rc_cache (CLOCK)", capacity );
+
+    std::cout << "---\n\n";
+
+    int label_witdh = 0;
+    for( auto const& x: times ) label_witdh = (std::max)((int)( x.label_ + ": " ).size(), label_witdh);
+
+    auto precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(3);
+
+    for (auto const& x : times)
+    {
+        std::cout << std::setw(label_witdh) << (x.label_ + ": ") <<
+        std::setw( 5 ) << x.time_ << " ms, hit ratio " << x.hit_ratio_ << "\n";
+    }
+
+    auto [pmint, pmaxt] = boost::minmax_element(
+        times.begin(), times.end(), [](const record& x, const record& y){ return x.time_< y.time_; });
+
+    std::cout << "\n" << std::setw( 28 ) << "Time(worst)/time(best): " << (float)(pmaxt->time_) / pmint->time_ << "\n";
+
+    std::cout << std::setprecision(precision) << std::defaultfloat<< "\n";
+}
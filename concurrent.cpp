@@ -0,0 +1,171 @@
+// Copyright 2022 Joaquin M Lopez Munoz.
+// Distributed under the Boost Software License, Version 1.0.
+// https://www.boost.org/LICENSE_1_0.txt
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+#include "container_defs.hpp"
+#include "fca_concurrent_unordered.hpp"
+
+using namespace std::chrono_literals;
+
+// Insert N random keys split among T threads, then have each thread look
+// up all the keys (half of them not present) K times
+
+constexpr unsigned N = 2'000'000;
+constexpr int K = 5;
+
+static std::vector< std::uint64_t > indices;
+
+static void init_indices()
+{
+    indices.push_back( 0 );
+
+    boost::detail::splitmix64 rng;
+
+    for( unsigned i = 1; i <= N*2; ++i )
+    {
+        indices.push_back( rng() );
+    }
+}
+
+// reference: single-threaded fca_unordered_map behind a reader-writer lock
+
+template<class K, class V>
+class locked_fca_fmod_unordered_map
+{
+public:
+    bool insert( std::pair<K, V> const& x )
+    {
+        std::unique_lock<std::shared_mutex> lk( mtx_ );
+        return map_.insert( { x.first, x.second } ).second;
+    }
+
+    template<class F> std::size_t visit( K const& k, F f ) const
+    {
+        std::shared_lock<std::shared_mutex> lk( mtx_ );
+        auto it = map_.find( k );
+        if( it == map_.end() ) return 0;
+        f( *it );
+        return 1;
+    }
+
+    std::size_t size() const { return map_.size(); }
+
+private:
+    mutable std::shared_mutex mtx_;
+    fca_fmod_unordered_map<K, V> map_;
+};
+
+template<class K, class V>
+using fca_concurrent_fmod_unordered_map =
+  fca_concurrent_unordered_map<
+    K, V, boost::hash<K>, std::equal_to<K>,
+    std::allocator<fxa_unordered::map_value_adaptor<K, V>>, // ::allocator is not thread safe
+    fxa_unordered::prime_fmod_size>;
+
+template<class F> static long long run_threads( unsigned T, F f )
+{
+    auto t1 = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+
+    for( unsigned t = 0; t < T; ++t )
+    {
+        threads.emplace_back( f, t );
+    }
+
+    for( auto& th: threads ) th.join();
+
+    return ( std::chrono::steady_clock::now() - t1 ) / 1ms;
+}
+
+struct record
+{
+    std::string label_;
+    unsigned threads_;
+    long long insert_time_;
+    long long lookup_time_;
+};
+
+static std::vector<record> times;
+
+template<template<class...> class Map> void BOOST_NOINLINE test( char const* label, unsigned T )
+{
+    std::cout << label << ", " << T << " thread(s):\n\n";
+
+    Map<std::uint64_t, std::uint64_t> map;
+
+    auto tinsert = run_threads( T, [&]( unsigned t )
+    {
+        for( unsigned i = 1 + t; i <= N; i += T )
+        {
+            map.insert( { indices[ i ], i } );
+        }
+    });
+
+    std::cout << "Random insert: " << tinsert << " ms (size=" << map.size() << ")\n";
+
+    std::atomic<std::uint64_t> s{ 0 };
+
+    auto tlookup = run_threads( T, [&]( unsigned )
+    {
+        std::uint64_t s2 = 0;
+
+        for( int j = 0; j < K; ++j )
+        {
+            for( unsigned i = 1; i <= N * 2; ++i )
+            {
+                map.visit( indices[ i ], [&]( auto const& x ){ s2 += x.second; } );
+            }
+        }
+
+        s += s2;
+    });
+
+    std::cout << "Random lookup: " << tlookup << " ms (s=" << s << ")\n\n";
+
+    times.push_back( { label, T, tinsert, tlookup } );
+}
+
+int main()
+{
+    init_indices();
+
+    std::vector<unsigned> thread_counts;
+
+    for( unsigned T = 1, maxT = (std::max)( std::thread::hardware_concurrency(), 1u ); ; T *= 2 )
+    {
+        thread_counts.push_back( (std::min)( T, maxT ) );
+        if( T >= maxT ) break;
+    }
+
+    for( auto T: thread_counts )
+    {
+        test<locked_fca_fmod_unordered_map>( "locked fca_fmod_unordered_map", T );
+        test<fca_concurrent_fmod_unordered_map>( "fca_concurrent_fmod_unordered_map", T );
+    }
+
+    std::cout << "---\n\n";
+
+    int label_witdh = 0;
+    for( auto const& x: times ) label_witdh = (std::max)((int)( x.label_ + ": " ).size(), label_witdh);
+
+    for (auto const& x : times)
+    {
+        std::cout << std::setw(label_witdh) << (x.label_ + ": ") <<
+        std::setw( 3 ) << x.threads_ << " threads, insert " <<
+        std::setw( 5 ) << x.insert_time_ << " ms, lookup " <<
+        std::setw( 5 ) << x.lookup_time_ << " ms\n";
+    }
+
+    std::cout << "\n";
+}
@@ -22,7 +22,9 @@
 #include <boost/core/detail/splitmix64.hpp>
 #include "fca_simple_unordered.hpp"
 #include "fca_unordered.hpp"
+#include "fca_compact_unordered.hpp"
 #include "foa_unordered_coalesced.hpp"
+#include "foa_unordered_dense.hpp"
 #include "foa_unordered_nway.hpp"
 #include "foa_unordered_hopscotch.hpp"
 #include "foa_unordered_longhop.hpp"
@@ -495,6 +497,35 @@ using fca_fmod_unordered_map =
     ::allocator<fxa_unordered::map_value_adaptor<K, V>>,
     fxa_unordered::prime_fmod_size>;
 
+template<class K, class V, class H=boost::hash<K>>
+using fca_fmod_unordered_incremental_map =
+  fca_unordered_map<
+    K, V, H, std::equal_to<K>,
+    ::allocator<fxa_unordered::map_value_adaptor<K, V>>,
+    fxa_unordered::prime_fmod_size,
+    fxa_unordered::grouped_buckets,
+    fxa_unordered::dynamic_node_allocation,
+    fxa_unordered::incremental_rehash>;
+
+template<class K, class V, class H=boost::hash<K>>
+using fca_fmod_unordered_hcached_map =
+  fca_unordered_map<
+    K, V, H, std::equal_to<K>,
+    ::allocator<fxa_unordered::map_value_adaptor<K, V>>,
+    fxa_unordered::prime_fmod_size,
+    fxa_unordered::grouped_buckets,
+    fxa_unordered::dynamic_node_allocation,
+    fxa_unordered::eager_rehash,
+    fxa_unordered::hcached_nodes>;
+
+template<class K, class V, class H=boost::hash<K>>
+using fca_fmod_unordered_fingerprinted_map =
+  fca_unordered_map<
+    K, V, H, std::equal_to<K>,
+    ::allocator<fxa_unordered::map_value_adaptor<K, V>>,
+    fxa_unordered::prime_fmod_size,
+    fxa_unordered::fingerprinted_buckets<>>;
+
 template<class K, class V, class H=boost::hash<K>>
 using fca_frng_unordered_map =
   fca_unordered_map<
@@ -620,6 +651,40 @@ using fca_fmod_bcached_unordered_pool_bucket_map =
     fxa_unordered::bcached_simple_buckets,
     fxa_unordered::pool_node_allocation>;
 
+template<class K, class V, class H=boost::hash<K>>
+using fca_fmod_unordered_slab_map =
+  fca_unordered_map<
+    K, V, H, std::equal_to<K>,
+    ::allocator<fxa_unordered::map_value_adaptor<K, V>>,
+    fxa_unordered::prime_fmod_size,
+    fxa_unordered::grouped_buckets,
+    fxa_unordered::slab_node_allocation<>>;
+
+template<class K, class V, class H=boost::hash<K>>
+using fca_fmod_unordered_slab_bucket_map =
+  fca_unordered_map<
+    K, V, H, std::equal_to<K>,
+    ::allocator<fxa_unordered::map_value_adaptor<K, V>>,
+    fxa_unordered::prime_fmod_size,
+    fxa_unordered::simple_buckets,
+    fxa_unordered::slab_node_allocation<>>;
+
+template<class K, class V, class H=boost::hash<K>>
+using fca_fmod_bcached_unordered_slab_bucket_map =
+  fca_unordered_map<
+    K, V, H, std::equal_to<K>,
+    ::allocator<fxa_unordered::map_value_adaptor<K, V>>,
+    fxa_unordered::prime_fmod_size,
+    fxa_unordered::bcached_simple_buckets,
+    fxa_unordered::slab_node_allocation<>>;
+
+template<class K, class V, class H=boost::hash<K>>
+using fca_fmod_unordered_compact_map =
+  fca_compact_unordered_map<
+    K, V, H, std::equal_to<K>,
+    ::allocator<fxa_unordered::map_value_adaptor<K, V>>,
+    fxa_unordered::prime_fmod_size>;
+
 template<class K, class V, class H=boost::hash<K>>
 using fca_fmod_unordered_embedded_map =
   fca_unordered_map<
@@ -884,6 +949,13 @@ using foa_mulx_unordered_rc15_map =
     ::allocator<fxa_unordered::map_value_adaptor<K, V>>,
     fxa_unordered::rc::group15>;
 
+template<class K, class V, class H=mulx_hash<K>>
+using foa_mulx_unordered_rcdk_map =
+  foa_unordered_rc_map<
+    K, V, H,std::equal_to<K>,
+    ::allocator<fxa_unordered::map_value_adaptor<K, V>>,
+    fxa_unordered::rc::direct_key_group<K>>;
+
 template<class K, class V, class H=xmxmx_hash<K>>
 using foa_xmxmx_unordered_rc16_map =
   foa_unordered_rc_map<
@@ -1419,6 +1491,23 @@ template<class K, class V> using ankerl_unordered_dense_map =
     ankerl::unordered_dense::map<K, V, ankerl::unordered_dense::hash<K>, std::equal_to<K>, ::allocator< std::pair<K, V>>>;
 #endif
 
+template<class K, class V, class H=mulx_hash<K>>
+using foa_mulx_unordered_dense_map =
+  foa_unordered_dense_map<
+    K, V, H,std::equal_to<K>,
+    ::allocator<fxa_unordered::map_value_adaptor<K, V>>>;
+
+template<class K, class V, class H=mulx_hash<K>>
+using foa_mulx_unordered_ordered_dense_map =
+  foa_unordered_dense_map<
+    K, V, H,std::equal_to<K>,
+    ::allocator<fxa_unordered::map_value_adaptor<K, V>>,
+    fxa_unordered::rc::group15,
+    fxa_unordered::pow2_size,
+    fxa_unordered::rc::pow2_prober,
+    fxa_unordered::shift_hash<0>,
+    fxa_unordered::dense::insertion_order>;
+
 template<class K, class V> using std_unordered_map_fnv1a =
     std::unordered_map<K, V, fnv1a_hash, std::equal_to<K>, allocator_for<K, V>>;
 
@@ -1452,6 +1541,9 @@ template<class K, class V> using fca_switch_unordered_map_fnv1a =
 template<class K, class V> using fca_fmod_unordered_map_fnv1a =
   fca_fmod_unordered_map<K, V, fnv1a_hash>;
 
+template<class K, class V> using fca_fmod_unordered_hcached_map_fnv1a =
+  fca_fmod_unordered_hcached_map<K, V, fnv1a_hash>;
+
 template<class K, class V> using fca_frng_unordered_map_fnv1a =
   fca_frng_unordered_map<K, V, fnv1a_hash>;
 
@@ -0,0 +1,373 @@
+/* Proof of concept of closed- and open-addressing
+ * unordered associative containers.
+ *
+ * Copyright 2022 Joaquin M Lopez Munoz.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef FCA_COMPACT_UNORDERED_HPP
+#define FCA_COMPACT_UNORDERED_HPP
+
+#include <boost/config.hpp>
+#include <boost/container_hash/hash.hpp>
+#include <boost/core/bit.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+#include <climits>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "fxa_common.hpp"
+
+namespace fxa_unordered{
+
+namespace compact_fca{
+
+/* Compact counterpart of fca_unordered_set with pool_node_allocation:
+ * nodes live in an array with one slot per bucket, and bucket heads and
+ * node links are 32-bit indices into that array (0 meaning null) instead
+ * of pointers. Occupied buckets are tracked with one bitmask per N
+ * buckets as in grouped_bucket_array; the list of non-empty groups is
+ * dropped and traversal scans the bitmasks instead. As with
+ * pool_node_allocation, elements are moved on rehashing (no pointer
+ * stability) and must be movable.
+ */
+
+template<typename T>
+struct node
+{
+  std::uint32_t next;
+  union{T value;};
+
+  node(){}
+  ~node(){}
+};
+
+template<
+  typename T,typename Hash=boost::hash<T>,typename Pred=std::equal_to<T>,
+  typename Allocator=std::allocator<T>,
+  typename SizePolicy=prime_size
+>
+class fca_compact_unordered_set
+{
+  using size_policy=SizePolicy;
+  using index_type=std::uint32_t;
+  using node_type=node<T>;
+  using alloc_traits=std::allocator_traits<Allocator>;
+  using node_allocator_type=
+    typename alloc_traits::template rebind_alloc<node_type>;
+  using index_allocator_type=
+    typename alloc_traits::template rebind_alloc<index_type>;
+  using bitmask_allocator_type=
+    typename alloc_traits::template rebind_alloc<std::size_t>;
+
+  static constexpr std::size_t N=sizeof(std::size_t)*CHAR_BIT;
+
+public:
+  using key_type=T;
+  using value_type=T;
+  using size_type=std::size_t;
+  using allocator_type=Allocator;
+
+  class const_iterator:public boost::iterator_facade<
+    const_iterator,const value_type,boost::forward_traversal_tag>
+  {
+  public:
+    const_iterator()=default;
+
+  private:
+    friend class fca_compact_unordered_set;
+    friend class boost::iterator_core_access;
+
+    const_iterator(
+      const fca_compact_unordered_set* c,index_type i,index_type pos):
+      c{c},i{i},pos{pos}{}
+
+    const value_type& dereference()const noexcept{return c->at(i).value;}
+    bool equal(const const_iterator& x)const noexcept{return i==x.i;}
+
+    void increment()noexcept
+    {
+      if(!(i=c->at(i).next))*this=c->first_from(std::size_t(pos)+1);
+    }
+
+    const fca_compact_unordered_set *c=nullptr;
+    index_type                      i=0,pos=0;
+  };
+  using iterator=const_iterator;
+
+  fca_compact_unordered_set()=default;
+
+  explicit fca_compact_unordered_set(const Allocator& al):
+    buckets{size_policy::size(size_index_),0,index_allocator_type(al)},
+    bitmasks{buckets.size()/N+1,0,bitmask_allocator_type(al)},
+    nodes{buckets.size(),node_allocator_type(al)}
+  {}
+
+  fca_compact_unordered_set(const fca_compact_unordered_set&)=delete;
+
+  ~fca_compact_unordered_set()
+  {
+    for(auto first=begin(),last=end();first!=last;++first){
+      destroy(first.i);
+    }
+  }
+
+  const_iterator begin()const noexcept{return first_from(0);}
+  const_iterator end()const noexcept{return {};}
+  size_type size()const noexcept{return size_;}
+  bool empty()const noexcept{return !size_;}
+  size_type bucket_count()const noexcept{return buckets.size();}
+
+  float load_factor()const noexcept
+  {
+    return static_cast<float>(size_)/static_cast<float>(bucket_count());
+  }
+
+  float max_load_factor()const noexcept{return mlf;}
+
+  /* capped at 1, as there is one node slot per bucket */
+  void max_load_factor(float z)
+  {
+    if(!(z>0.0f)){
+      throw std::invalid_argument(
+        "fca_compact_unordered_set: invalid max load factor");
+    }
+    if(z>1.0f)z=1.0f;
+    mlf=z;
+    ml=max_load();
+    if(size_>ml)rehash(size_);
+  }
+
+  void reserve(size_type n)
+  {
+    if(n>ml)rehash(n);
+  }
+
+  allocator_type get_allocator()const{return allocator_type(nodes.get_allocator());}
+
+  auto insert(const T& x){return insert_impl(x);}
+  auto insert(T&& x){return insert_impl(std::move(x));}
+
+  iterator erase(const_iterator pos)
+  {
+    auto next=std::next(pos);
+    auto pl=&buckets[pos.pos];
+    while(*pl!=pos.i)pl=&at(*pl).next;
+    unlink(pl,pos.pos);
+    return next;
+  }
+
+  template<typename Key>
+  size_type erase(const Key& x)
+  {
+    auto pos=position(h(x));
+    for(auto pl=&buckets[pos];*pl;pl=&at(*pl).next){
+      if(BOOST_LIKELY(pred(x,at(*pl).value))){
+        unlink(pl,pos);
+        return 1;
+      }
+    }
+    return 0;
+  }
+
+  template<typename Key>
+  iterator find(const Key& x)const
+  {
+    auto pos=position(h(x));
+    for(auto i=buckets[pos];i;i=at(i).next){
+      if(BOOST_LIKELY(pred(x,at(i).value))){
+        return {this,i,static_cast<index_type>(pos)};
+      }
+    }
+    return end();
+  }
+
+private:
+  node_type& at(index_type i){return nodes[i-1];}
+  const node_type& at(index_type i)const{return nodes[i-1];}
+
+  std::size_t position(std::size_t hash)const
+  {
+    return size_policy::position(hash,size_index_);
+  }
+
+  const_iterator first_from(std::size_t pos)const noexcept
+  {
+    auto n=pos/N;
+    if(n>=bitmasks.size())return end();
+    auto mask=bitmasks[n]&reset_first_bits(pos%N);
+    while(!mask){
+      if(++n==bitmasks.size())return end();
+      mask=bitmasks[n];
+    }
+    pos=n*N+boost::core::countr_zero(mask);
+    return {this,buckets[pos],static_cast<index_type>(pos)};
+  }
+
+  static std::size_t reset_first_bits(std::size_t n)
+  {
+    return ~((std::size_t(1)<<n)-1);
+  }
+
+  template<typename Value>
+  std::pair<iterator,bool> insert_impl(Value&& x)
+  {
+    auto hash=h(x);
+    auto pos=position(hash);
+    for(auto i=buckets[pos];i;i=at(i).next){
+      if(pred(x,at(i).value))return {{this,i,static_cast<index_type>(pos)},false};
+    }
+
+    if(BOOST_UNLIKELY(size_+1>ml)){
+      rehash(size_+1);
+      pos=position(hash);
+    }
+
+    auto i=allocate();
+    try{
+      auto a=get_allocator();
+      alloc_traits::construct(a,&at(i).value,std::forward<Value>(x));
+    }
+    catch(...){
+      deallocate(i);
+      throw;
+    }
+    link(i,pos);
+    ++size_;
+    return {{this,i,static_cast<index_type>(pos)},true};
+  }
+
+  index_type allocate()
+  {
+    if(free){
+      auto i=free;
+      free=at(i).next;
+      return i;
+    }
+    else return ++top;
+  }
+
+  void deallocate(index_type i)
+  {
+    at(i).next=free;
+    free=i;
+  }
+
+  void destroy(index_type i)
+  {
+    auto a=get_allocator();
+    alloc_traits::destroy(a,&at(i).value);
+  }
+
+  void link(index_type i,std::size_t pos)
+  {
+    at(i).next=buckets[pos];
+    buckets[pos]=i;
+    bitmasks[pos/N]|=std::size_t(1)<<(pos%N);
+  }
+
+  void unlink(index_type* pl,std::size_t pos)
+  {
+    auto i=*pl;
+    *pl=at(i).next;
+    if(!buckets[pos])bitmasks[pos/N]&=~(std::size_t(1)<<(pos%N));
+    destroy(i);
+    deallocate(i);
+    --size_;
+  }
+
+  void rehash(size_type n)
+  {
+    std::size_t bc =(std::numeric_limits<std::size_t>::max)();
+    float       fbc=1.0f+static_cast<float>(n)/mlf;
+    if(bc>fbc)bc=static_cast<std::size_t>(fbc);
+
+    fca_compact_unordered_set x{bc,nodes.get_allocator()};
+    auto                      a=get_allocator();
+    for(auto first=begin(),last=end();first!=last;++first){
+      auto i=++x.top;
+      alloc_traits::construct(
+        a,&x.at(i).value,std::move_if_noexcept(at(first.i).value));
+      x.link(i,x.position(h(x.at(i).value)));
+      ++x.size_;
+    }
+    swap(x);
+    ml=max_load(); /* x was built with the default mlf */
+  }
+
+  fca_compact_unordered_set(std::size_t n,const node_allocator_type& al):
+    size_index_{size_policy::size_index(n)},
+    buckets{size_policy::size(size_index_),0,index_allocator_type(al)},
+    bitmasks{buckets.size()/N+1,0,bitmask_allocator_type(al)},
+    nodes{buckets.size(),al},
+    ml{max_load()}
+  {
+    if(buckets.size()>=(std::numeric_limits<index_type>::max)()){
+      throw std::length_error("fca_compact_unordered_set: too many elements");
+    }
+  }
+
+  void swap(fca_compact_unordered_set& x)noexcept
+  {
+    std::swap(size_index_,x.size_index_);
+    std::swap(size_,x.size_);
+    std::swap(top,x.top);
+    std::swap(free,x.free);
+    std::swap(ml,x.ml);
+    buckets.swap(x.buckets);
+    bitmasks.swap(x.bitmasks);
+    nodes.swap(x.nodes);
+  }
+
+  size_type max_load()const
+  {
+    float fml=mlf*static_cast<float>(buckets.size());
+    auto res=(std::numeric_limits<size_type>::max)();
+    if(res>fml)res=static_cast<size_type>(fml);
+    if(res>nodes.size())res=nodes.size();
+    return res;
+  }
+
+  Hash                                                h;
+  Pred                                                pred;
+  float                                               mlf=1.0f;
+  std::size_t                                         size_index_=
+                                                        size_policy::size_index(0);
+  size_type                                           size_=0;
+  index_type                                          top=0,free=0;
+  std::vector<index_type,index_allocator_type>        buckets=
+    std::vector<index_type,index_allocator_type>(size_policy::size(size_index_),0);
+  std::vector<std::size_t,bitmask_allocator_type>     bitmasks=
+    std::vector<std::size_t,bitmask_allocator_type>(buckets.size()/N+1,0);
+  std::vector<node_type,node_allocator_type>          nodes=
+    std::vector<node_type,node_allocator_type>(buckets.size());
+  size_type                                           ml=max_load();
+};
+
+} // namespace compact_fca
+
+template<
+  typename Key,typename Value,
+  typename Hash=boost::hash<Key>,typename Pred=std::equal_to<Key>,
+  typename Allocator=std::allocator<map_value_adaptor<Key,Value>>,
+  typename SizePolicy=prime_size
+>
+using fca_compact_unordered_map=compact_fca::fca_compact_unordered_set<
+  map_value_adaptor<Key,Value>,
+  map_hash_adaptor<Hash>,map_pred_adaptor<Pred>,
+  Allocator,SizePolicy
+>;
+
+} // namespace fxa_unordered
+
+using fxa_unordered::compact_fca::fca_compact_unordered_set;
+using fxa_unordered::fca_compact_unordered_map;
+
+#endif
@@ -0,0 +1,668 @@
+/* Proof of concept of closed- and open-addressing
+ * unordered associative containers.
+ *
+ * Copyright 2022 Joaquin M Lopez Munoz.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef FCA_CONCURRENT_UNORDERED_HPP
+#define FCA_CONCURRENT_UNORDERED_HPP
+
+#include <boost/config.hpp>
+#include <boost/container_hash/hash.hpp>
+#include <boost/core/bit.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "fxa_common.hpp"
+
+namespace fxa_unordered{
+
+namespace cfca{
+
+/* Concurrent counterpart of fca_unordered_set with grouped_buckets: nodes
+ * are allocated individually and never move, buckets are grouped in
+ * runs of N=64 as in grouped_bucket_array, and the bucket group carries
+ * the lock word for its buckets alongside the occupancy bitmask. The
+ * doubly linked list of non-empty groups is dropped: traversal scans the
+ * group array instead, skipping empty groups with one bitmask load each.
+ *
+ * Writers (insertion, erasure) lock the group of the target bucket only.
+ * Readers take no locks: links are atomic and new nodes are published
+ * with a release store on the bucket head, so a chain can be walked while
+ * it is being modified. Unlinked nodes are not freed right away but
+ * retired and reclaimed once no reader can still be traversing them,
+ * using per-thread-slot reader counters with two alternating phases
+ * (as in SRCU). Rehashing locks all groups and relinks the existing
+ * nodes into a new bucket array; a reader missing a lookup during a
+ * rehash retries once the new array is published. Links being atomic
+ * raw pointers, Allocator can't have fancy pointers.
+ */
+
+class spinlock
+{
+public:
+  void lock()noexcept
+  {
+    for(unsigned n=0;;++n){
+      if(!locked.load(std::memory_order_relaxed)&&
+         !locked.exchange(true,std::memory_order_acquire))return;
+      if(n>=spin_limit)std::this_thread::yield();
+    }
+  }
+
+  void unlock()noexcept{locked.store(false,std::memory_order_release);}
+
+private:
+  static constexpr unsigned spin_limit=64;
+
+  std::atomic<bool> locked{false};
+};
+
+struct node_base
+{
+  std::atomic<node_base*> next;
+};
+
+template<typename T>
+struct node:node_base
+{
+  T value;
+};
+
+struct bucket
+{
+  std::atomic<node_base*> next{nullptr};
+};
+
+struct bucket_group
+{
+  static constexpr std::size_t N=sizeof(std::size_t)*CHAR_BIT;
+
+  spinlock    lock;
+  std::size_t bitmask=0; /* protected by lock */
+};
+
+template<typename Allocator,typename SizePolicy>
+struct bucket_table
+{
+  using size_policy=SizePolicy;
+  using alloc_traits=std::allocator_traits<Allocator>;
+  static constexpr auto N=bucket_group::N;
+
+  bucket_table(std::size_t n,float mlf,const Allocator& al):
+    size_index{size_policy::size_index(n)},
+    size{size_policy::size(size_index)},
+    buckets(size,al),
+    groups(size/N+1,al)
+  {
+    float fml=mlf*static_cast<float>(size);
+    ml=(std::numeric_limits<std::size_t>::max)();
+    if(ml>fml)ml=static_cast<std::size_t>(fml);
+  }
+
+  std::size_t position(std::size_t hash)const
+  {
+    return size_policy::position(hash,size_index);
+  }
+
+  bucket_group& group_for(std::size_t pos){return groups[pos/N];}
+
+  std::size_t  size_index;
+  std::size_t  size;
+  std::size_t  ml;
+  std::vector<
+    bucket,typename alloc_traits::template rebind_alloc<bucket>>
+               buckets;
+  std::vector<
+    bucket_group,typename alloc_traits::template rebind_alloc<bucket_group>>
+               groups;
+  bucket_table *next_retired=nullptr;
+};
+
+inline std::size_t thread_index()
+{
+  static std::atomic<std::size_t> counter{0};
+  thread_local std::size_t        n=
+    counter.fetch_add(1,std::memory_order_relaxed);
+  return n;
+}
+
+template<
+  typename T,typename Hash=boost::hash<T>,typename Pred=std::equal_to<T>,
+  typename Allocator=std::allocator<T>,
+  typename SizePolicy=prime_size
+>
+class fca_concurrent_unordered_set
+{
+  using alloc_traits=std::allocator_traits<Allocator>;
+  using node_type=node<T>;
+  using node_allocator_type=
+    typename alloc_traits::template rebind_alloc<node_type>;
+  using node_alloc_traits=std::allocator_traits<node_allocator_type>;
+  using table_type=bucket_table<Allocator,SizePolicy>;
+  using table_allocator_type=
+    typename alloc_traits::template rebind_alloc<table_type>;
+  using table_alloc_traits=std::allocator_traits<table_allocator_type>;
+  using node_vector=std::vector<
+    node_type*,typename alloc_traits::template rebind_alloc<node_type*>>;
+  static constexpr auto N=bucket_group::N;
+
+  /* threads are spread over slots, each with its reader counters (one
+   * per phase) and its list of retired nodes
+   */
+  static constexpr std::size_t num_slots=64;
+  static constexpr std::size_t reclaim_threshold=256;
+
+  struct alignas(64) reclamation_slot
+  {
+    explicit reclamation_slot(const Allocator& al):retired(al){}
+
+    std::atomic<std::size_t> readers[2]={0,0};
+    spinlock                 retired_lock;
+    node_vector              retired;
+  };
+
+public:
+  using key_type=T;
+  using value_type=T;
+  using size_type=std::size_t;
+  using allocator_type=Allocator;
+
+  fca_concurrent_unordered_set():fca_concurrent_unordered_set(Allocator()){}
+
+  explicit fca_concurrent_unordered_set(const Allocator& al_):
+    al{al_},
+    slots{make_slots(al_,std::make_index_sequence<num_slots>{})},
+    table{new_table(0)}
+  {}
+
+  fca_concurrent_unordered_set(const fca_concurrent_unordered_set&)=delete;
+  fca_concurrent_unordered_set& operator=(
+    const fca_concurrent_unordered_set&)=delete;
+
+  ~fca_concurrent_unordered_set()
+  {
+    auto t=table.load(std::memory_order_relaxed);
+    for(auto& b:t->buckets){
+      for(auto p=b.next.load(std::memory_order_relaxed);p;){
+        auto next=p->next.load(std::memory_order_relaxed);
+        delete_node(static_cast<node_type*>(p));
+        p=next;
+      }
+    }
+    delete_table(t);
+    for(auto& s:slots){
+      for(auto p:s.retired)delete_node(p);
+    }
+    for(auto t2=retired_tables;t2;){
+      auto next=t2->next_retired;
+      delete_table(t2);
+      t2=next;
+    }
+  }
+
+  size_type size()const noexcept
+  {
+    return size_.load(std::memory_order_relaxed);
+  }
+
+  bool empty()const noexcept{return size()==0;}
+
+  size_type bucket_count()const noexcept
+  {
+    reader_guard rg{*this};
+    return table.load(std::memory_order_acquire)->size;
+  }
+
+  float load_factor()const noexcept
+  {
+    return static_cast<float>(size())/static_cast<float>(bucket_count());
+  }
+
+  float max_load_factor()const noexcept
+  {
+    return mlf.load(std::memory_order_relaxed);
+  }
+
+  /* the table is rebuilt right away so that the new factor applies */
+  void max_load_factor(float z)
+  {
+    if(!(z>0.0f)){
+      throw std::invalid_argument(
+        "fca_concurrent_unordered_set: invalid max load factor");
+    }
+    std::unique_lock<std::shared_mutex> lk{rehash_mtx};
+    mlf.store(z,std::memory_order_relaxed);
+    auto t=table.load(std::memory_order_relaxed);
+    rebuild(t,(std::max)(t->size,bucket_count_for(size())));
+  }
+
+  void reserve(size_type n){rehash(n);}
+
+  allocator_type get_allocator()const noexcept{return al;}
+
+  bool insert(const T& x){return insert_impl(x,[](const value_type&){});}
+  bool insert(T&& x){return insert_impl(std::move(x),[](const value_type&){});}
+
+  /* returns true if x was inserted, otherwise f is invoked on the
+   * equivalent element with its group locked
+   */
+  template<typename F>
+  bool insert_or_visit(const T& x,F f){return insert_impl(x,f);}
+
+  template<typename F>
+  bool insert_or_visit(T&& x,F f){return insert_impl(std::move(x),f);}
+
+  /* maps only: update is invoked with the group locked, so updates to the
+   * same element are serialized; lock-free visit may read the mapped value
+   * concurrently, which is only safe for atomic mapped types
+   */
+  template<typename Key,typename Init,typename Update>
+  bool upsert(const Key& k,Init&& init,Update update)
+  {
+    return emplace_impl(
+      k,
+      [&](const value_type& x){update(x.second);},
+      k,std::forward<Init>(init));
+  }
+
+  /* maps only */
+  template<typename Key,typename Delta>
+  bool add(const Key& k,const Delta& delta)
+  {
+    return upsert(k,delta,[&](auto& v){v+=delta;});
+  }
+
+  /* lock-free: f is invoked on the element equivalent to x, if any, which
+   * stays valid for the duration of the call even if concurrently erased
+   */
+  template<typename Key,typename F>
+  size_type visit(const Key& x,F f)const
+  {
+    auto         hash=h(x);
+    reader_guard rg{*this};
+    for(;;){
+      auto seq=rehash_seq.load(std::memory_order_acquire);
+      auto t=table.load(std::memory_order_acquire);
+      if(auto p=find_node(x,*t,t->position(hash))){
+        f(static_cast<const value_type&>(p->value));
+        return 1;
+      }
+      if(!(seq&1)&&rehash_seq.load(std::memory_order_acquire)==seq)return 0;
+      std::this_thread::yield(); /* a miss during rehashing is retried */
+    }
+  }
+
+  template<typename Key>
+  size_type count(const Key& x)const
+  {
+    return visit(x,[](const value_type&){});
+  }
+
+  template<typename Key>
+  bool contains(const Key& x)const{return count(x)!=0;}
+
+  template<typename Key>
+  size_type erase(const Key& x)
+  {
+    auto         hash=h(x);
+    reader_guard rg{*this};
+    for(;;){
+      auto t=table.load(std::memory_order_acquire);
+      auto pos=t->position(hash);
+      auto& g=t->group_for(pos);
+      std::lock_guard<spinlock> lk{g.lock};
+      if(t!=table.load(std::memory_order_relaxed))continue;
+
+      auto& b=t->buckets[pos];
+      for(auto pp=&b.next;;){
+        auto p=pp->load(std::memory_order_relaxed);
+        if(!p)return 0;
+        if(pred(x,static_cast<node_type*>(p)->value)){
+          /* p must be unlinked before try_reclaim can see it retired: the
+           * slot stays locked throughout, with room made in advance so
+           * that nothing throws once p is unlinked
+           */
+          auto& s=slots[thread_index()%num_slots];
+          std::lock_guard<spinlock> slk{s.retired_lock};
+          if(s.retired.size()==s.retired.capacity()){
+            s.retired.reserve(2*s.retired.size()+1);
+          }
+          pp->store(
+            p->next.load(std::memory_order_relaxed),
+            std::memory_order_release);
+          retire(s,static_cast<node_type*>(p));
+          if(!b.next.load(std::memory_order_relaxed)){
+            g.bitmask&=reset_bit(pos%N);
+          }
+          size_.fetch_sub(1,std::memory_order_relaxed);
+          return 1;
+        }
+        pp=&p->next;
+      }
+    }
+  }
+
+  /* f is invoked on all the elements, a group at a time with the group
+   * locked; rehashing is blocked for the duration of the traversal
+   */
+  template<typename F>
+  void for_each(F f)const
+  {
+    std::shared_lock<std::shared_mutex> lk{rehash_mtx};
+    auto t=table.load(std::memory_order_acquire);
+    for(std::size_t i=0,last=t->groups.size();i!=last;++i){
+      auto& g=t->groups[i];
+      std::lock_guard<spinlock> glk{g.lock};
+      for(auto mask=g.bitmask;mask;mask&=mask-1){
+        auto pos=i*N+(std::size_t)boost::core::countr_zero(mask);
+        for(auto p=t->buckets[pos].next.load(std::memory_order_relaxed);p;
+            p=p->next.load(std::memory_order_relaxed)){
+          f(static_cast<const value_type&>(
+            static_cast<node_type*>(p)->value));
+        }
+      }
+    }
+  }
+
+private:
+  /* marks the calling thread as reading for the duration of the scope,
+   * then reclaims retired memory if due (and not nested in another read)
+   */
+  struct reader_guard
+  {
+    reader_guard(const fca_concurrent_unordered_set& x_):
+      x{const_cast<fca_concurrent_unordered_set&>(x_)},
+      slot{x.slots[thread_index()%num_slots]},
+      phase{x.phase.load(std::memory_order_seq_cst)&1}
+    {
+      slot.readers[phase].fetch_add(1,std::memory_order_seq_cst);
+    }
+
+    ~reader_guard()
+    {
+      slot.readers[phase].fetch_sub(1,std::memory_order_release);
+      if(x.reclaim_pending.load(std::memory_order_relaxed)&&
+         !slot.readers[0].load(std::memory_order_relaxed)&&
+         !slot.readers[1].load(std::memory_order_relaxed)){
+        x.try_reclaim();
+      }
+    }
+
+    fca_concurrent_unordered_set &x;
+    reclamation_slot             &slot;
+    std::size_t                   phase;
+  };
+
+  template<std::size_t... I>
+  static std::array<reclamation_slot,num_slots> make_slots(
+    const Allocator& al,std::index_sequence<I...>)
+  {
+    return {{(static_cast<void>(I),reclamation_slot{al})...}};
+  }
+
+  template<typename Value,typename F>
+  bool insert_impl(Value&& x,F f)
+  {
+    return emplace_impl(x,f,std::forward<Value>(x));
+  }
+
+  /* the element is constructed in place from args, with the group locked,
+   * only if no equivalent one is found
+   */
+  template<typename Key,typename F,typename... Args>
+  bool emplace_impl(const Key& x,F f,Args&&... args)
+  {
+    auto         hash=h(x);
+    reader_guard rg{*this};
+    for(;;){
+      auto t=table.load(std::memory_order_acquire);
+      auto pos=t->position(hash);
+      auto& g=t->group_for(pos);
+      std::unique_lock<spinlock> lk{g.lock};
+      if(t!=table.load(std::memory_order_relaxed))continue;
+
+      auto& b=t->buckets[pos];
+      if(auto p=find_node(x,*t,pos)){
+        f(static_cast<const value_type&>(p->value));
+        return false;
+      }
+      auto n=size_.load(std::memory_order_relaxed)+1;
+      if(BOOST_UNLIKELY(n>t->ml)){
+        lk.unlock();
+        rehash(n);
+        continue;
+      }
+
+      auto p=new_node(std::forward<Args>(args)...);
+      p->next.store(
+        b.next.load(std::memory_order_relaxed),std::memory_order_relaxed);
+      b.next.store(p,std::memory_order_release);
+      g.bitmask|=set_bit(pos%N);
+      size_.fetch_add(1,std::memory_order_relaxed);
+      return true;
+    }
+  }
+
+  template<typename Key>
+  node_type* find_node(const Key& x,const table_type& t,std::size_t pos)const
+  {
+    for(auto p=t.buckets[pos].next.load(std::memory_order_acquire);p;
+        p=p->next.load(std::memory_order_acquire)){
+      if(BOOST_LIKELY(pred(x,static_cast<node_type*>(p)->value))){
+        return static_cast<node_type*>(p);
+      }
+    }
+    return nullptr;
+  }
+
+  void rehash(size_type n)
+  {
+    std::unique_lock<std::shared_mutex> lk{rehash_mtx};
+    auto t=table.load(std::memory_order_relaxed);
+    if(n<=t->ml)return; /* some other thread got here first */
+    rebuild(t,bucket_count_for(n));
+  }
+
+  std::size_t bucket_count_for(size_type n)const
+  {
+    std::size_t bc =(std::numeric_limits<std::size_t>::max)();
+    float       fbc=1.0f+static_cast<float>(n)/
+                      mlf.load(std::memory_order_relaxed);
+    if(bc>fbc)bc=static_cast<std::size_t>(fbc);
+    return bc;
+  }
+
+  /* rehash_mtx must be held, Hash must not throw */
+  void rebuild(table_type* t,std::size_t bc)
+  {
+    auto nt=new_table(bc);
+
+    for(auto& g:t->groups)g.lock.lock();
+    auto seq=rehash_seq.load(std::memory_order_relaxed);
+    rehash_seq.store(seq+1,std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for(auto& b:t->buckets){
+      for(auto p=b.next.load(std::memory_order_relaxed);p;){
+        auto next=p->next.load(std::memory_order_relaxed);
+        auto pos=nt->position(h(static_cast<node_type*>(p)->value));
+        auto& nb=nt->buckets[pos];
+        p->next.store(
+          nb.next.load(std::memory_order_relaxed),std::memory_order_release);
+        nb.next.store(p,std::memory_order_release);
+        nt->group_for(pos).bitmask|=set_bit(pos%N);
+        p=next;
+      }
+    }
+    table.store(nt,std::memory_order_release);
+    rehash_seq.store(seq+2,std::memory_order_release);
+    for(auto& g:t->groups)g.lock.unlock();
+
+    {
+      std::lock_guard<spinlock> rlk{retired_tables_lock};
+      t->next_retired=retired_tables;
+      retired_tables=t;
+    }
+    reclaim_pending.store(true,std::memory_order_relaxed);
+  }
+
+  /* s.retired_lock must be held and s.retired have room for p */
+  void retire(reclamation_slot& s,node_type* p)noexcept
+  {
+    s.retired.push_back(p);
+    if(s.retired.size()>=reclaim_threshold){
+      reclaim_pending.store(true,std::memory_order_relaxed);
+    }
+  }
+
+  /* called outside any read section; if another thread is already
+   * reclaiming, nothing is done. Nodes retired after the snapshot are
+   * appended to the slot vectors and left for the next round.
+   */
+  void try_reclaim()noexcept
+  {
+    std::unique_lock<std::mutex> lk{reclaim_mtx,std::try_to_lock};
+    if(!lk.owns_lock())return;
+    reclaim_pending.store(false,std::memory_order_relaxed);
+
+    std::array<std::size_t,num_slots> counts;
+    table_type                        *tables;
+    for(std::size_t i=0;i<num_slots;++i){
+      std::lock_guard<spinlock> slk{slots[i].retired_lock};
+      counts[i]=slots[i].retired.size();
+    }
+    {
+      std::lock_guard<spinlock> rlk{retired_tables_lock};
+      tables=retired_tables;
+      retired_tables=nullptr;
+    }
+
+    synchronize();
+    for(std::size_t i=0;i<num_slots;++i){
+      if(!counts[i])continue;
+      std::lock_guard<spinlock> slk{slots[i].retired_lock};
+      auto& retired=slots[i].retired;
+      for(std::size_t k=0;k<counts[i];++k)delete_node(retired[k]);
+      retired.erase(
+        retired.begin(),retired.begin()+(std::ptrdiff_t)counts[i]);
+    }
+    while(tables){
+      auto next=tables->next_retired;
+      delete_table(tables);
+      tables=next;
+    }
+  }
+
+  /* waits until all the read sections begun before the call are over:
+   * two phase flips are needed as a reader may have fetched the phase
+   * right before the first flip and registered right after it
+   */
+  void synchronize()noexcept
+  {
+    for(int i=0;i<2;++i){
+      auto old_phase=phase.fetch_add(1,std::memory_order_seq_cst)&1;
+      for(auto& s:slots){
+        while(s.readers[old_phase].load(std::memory_order_seq_cst)){
+          std::this_thread::yield();
+        }
+      }
+    }
+  }
+
+  template<typename... Args>
+  node_type* new_node(Args&&... args)
+  {
+    node_allocator_type nal{al};
+    auto p=node_alloc_traits::allocate(nal,1);
+    try{
+      alloc_traits::construct(al,&p->value,std::forward<Args>(args)...);
+    }
+    catch(...){
+      node_alloc_traits::deallocate(nal,p,1);
+      throw;
+    }
+    ::new (&p->next) std::atomic<node_base*>(nullptr);
+    return p;
+  }
+
+  void delete_node(node_type* p)
+  {
+    node_allocator_type nal{al};
+    alloc_traits::destroy(al,&p->value);
+    node_alloc_traits::deallocate(nal,p,1);
+  }
+
+  table_type* new_table(std::size_t n)
+  {
+    table_allocator_type tal{al};
+    auto p=table_alloc_traits::allocate(tal,1);
+    try{
+      table_alloc_traits::construct(
+        tal,p,n,mlf.load(std::memory_order_relaxed),al);
+    }
+    catch(...){
+      table_alloc_traits::deallocate(tal,p,1);
+      throw;
+    }
+    return p;
+  }
+
+  void delete_table(table_type* p)
+  {
+    table_allocator_type tal{al};
+    table_alloc_traits::destroy(tal,p);
+    table_alloc_traits::deallocate(tal,p,1);
+  }
+
+  Hash                                   h;
+  Pred                                   pred;
+  Allocator                              al;
+  std::atomic<float>                     mlf{1.0f};
+  std::array<reclamation_slot,num_slots> slots;
+  std::atomic<table_type*>               table;
+  alignas(64) std::atomic<size_type>     size_{0};
+  alignas(64) std::atomic<std::size_t>   rehash_seq{0};
+  std::atomic<std::size_t>               phase{0};
+  std::atomic<bool>                      reclaim_pending{false};
+  mutable std::shared_mutex              rehash_mtx;
+  std::mutex                             reclaim_mtx;
+  spinlock                               retired_tables_lock;
+  table_type                            *retired_tables=nullptr;
+};
+
+} // namespace cfca
+
+template<
+  typename Key,typename Value,
+  typename Hash=boost::hash<Key>,typename Pred=std::equal_to<Key>,
+  typename Allocator=std::allocator<map_value_adaptor<Key,Value>>,
+  typename SizePolicy=prime_size
+>
+using fca_concurrent_unordered_map=cfca::fca_concurrent_unordered_set<
+  map_value_adaptor<Key,Value>,
+  map_hash_adaptor<Hash>,map_pred_adaptor<Pred>,
+  Allocator,SizePolicy
+>;
+
+} // namespace fxa_unordered
+
+using fxa_unordered::cfca::fca_concurrent_unordered_set;
+using fxa_unordered::fca_concurrent_unordered_map;
+
+#endif
@@ -16,6 +16,7 @@
 #include <functional>
 #include <limits>
 #include <memory>
+#include <stdexcept>
 #include <vector>
 
 namespace fca_simple_unordered_impl{
@@ -222,6 +223,30 @@ public:
   }
   
   size_type size()const noexcept{return size_;}
+  size_type bucket_count()const noexcept{return buckets.size();}
+
+  float load_factor()const noexcept
+  {
+    return static_cast<float>(size_)/static_cast<float>(bucket_count());
+  }
+
+  float max_load_factor()const noexcept{return mlf;}
+
+  void max_load_factor(float z)
+  {
+    if(!(z>0.0f)){
+      throw std::invalid_argument(
+        "fca_unordered_set: invalid max load factor");
+    }
+    mlf=z;
+    ml=max_load();
+    if(size_>ml)rehash(size_);
+  }
+
+  void reserve(size_type n)
+  {
+    if(n>ml)rehash(n);
+  }
 
   auto insert(const T& x){return insert_impl(x);}
   auto insert(T&& x){return insert_impl(std::move(x));}
@@ -288,37 +313,7 @@ private:
     if(it!=end())return {it,false};
         
     if(size_+1>ml){
-      std::size_t bc =(std::numeric_limits<std::size_t>::max)();
-      float       fbc=1.0f+static_cast<float>(size_+1)/mlf;
-      if(bc>fbc)bc=static_cast<std::size_t>(fbc);
-
-      bucket_array_type new_buckets(bc,al);
-      try{
-        for(auto& b:buckets){
-          for(auto p=b.node;p;){
-            auto next_p=p->next;
-            new_buckets.insert_node(
-              new_buckets.at(new_buckets.position(h(p->value))),p);
-            b.node=p=next_p;
-          }
-        }
-      }
-      catch(...){
-        for(auto& b:new_buckets){
-          for(auto p=b.node;p;){
-            auto next_p=p->next;
-            delete_node(p);
-            --size_;
-            p=next_p;
-          }
-        }
-        for(auto& b:buckets){
-          if(!b.node&&b.next)buckets.unlink_bucket(&b);
-        }
-        throw;
-      }
-      buckets=std::move(new_buckets);
-      ml=max_load();
+      rehash(size_+1);
       pos=buckets.position(hash);
     }
     
@@ -329,6 +324,41 @@ private:
     return {{p,pb},true};
   }
   
+  void rehash(size_type n)
+  {
+    std::size_t bc =(std::numeric_limits<std::size_t>::max)();
+    float       fbc=1.0f+static_cast<float>(n)/mlf;
+    if(bc>fbc)bc=static_cast<std::size_t>(fbc);
+
+    bucket_array_type new_buckets(bc,al);
+    try{
+      for(auto& b:buckets){
+        for(auto p=b.node;p;){
+          auto next_p=p->next;
+          new_buckets.insert_node(
+            new_buckets.at(new_buckets.position(h(p->value))),p);
+          b.node=p=next_p;
+        }
+      }
+    }
+    catch(...){
+      for(auto& b:new_buckets){
+        for(auto p=b.node;p;){
+          auto next_p=p->next;
+          delete_node(p);
+          --size_;
+          p=next_p;
+        }
+      }
+      for(auto& b:buckets){
+        if(!b.node&&b.next)buckets.unlink_bucket(&b);
+      }
+      throw;
+    }
+    buckets=std::move(new_buckets);
+    ml=max_load();
+  }
+
   template<typename Key>
   iterator find(const Key& x,size_type pos)const
   {
@@ -13,31 +13,67 @@
 #include <boost/config.hpp>
 #include <boost/container_hash/hash.hpp>
 #include <boost/core/bit.hpp>
+#include <boost/core/pointer_traits.hpp>
 #include <boost/iterator/iterator_facade.hpp>
+#include <algorithm>
 #include <climits>
 #include <cstdint>
 #include <functional>
+#include <iterator>
 #include <limits>
 #include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
 #include <type_traits>
+#include <utility>
 #include <vector>
 #include "fxa_common.hpp"
 
 namespace fxa_unordered{    
 
-struct bucket
+/* Links are stored as VoidPointer rebinds (the allocator's void_pointer)
+ * so that the structure can live in shared memory when using fancy
+ * pointers such as boost::interprocess::offset_ptr; algorithms work on
+ * raw pointers obtained with to_raw and convert back with to_pointer.
+ */
+
+template<typename Pointer>
+inline auto to_raw(const Pointer& p){return boost::to_address(p);}
+
+template<typename Pointer,typename T>
+inline Pointer to_pointer(T* p)
+{
+  return p?std::pointer_traits<Pointer>::pointer_to(*p):Pointer();
+}
+
+template<typename VoidPointer>
+struct basic_bucket
 {
-  bucket *next=nullptr;
+  using void_pointer=VoidPointer;
+  using bucket_type=basic_bucket;
+  using pointer=typename std::pointer_traits<VoidPointer>::
+    template rebind<basic_bucket>;
+
+  pointer next=nullptr;
 };
 
+using bucket=basic_bucket<void*>;
+
 template<typename Bucket>
 struct bucket_group
 {
   static constexpr std::size_t N=sizeof(std::size_t)*8;
 
-  Bucket       *buckets;
-  std::size_t  bitmask=0;
-  bucket_group *next=nullptr,*prev=nullptr;
+  using void_pointer=typename Bucket::void_pointer;
+  using bucket_pointer=typename std::pointer_traits<void_pointer>::
+    template rebind<Bucket>;
+  using pointer=typename std::pointer_traits<void_pointer>::
+    template rebind<bucket_group>;
+
+  bucket_pointer buckets;
+  std::size_t    bitmask=0;
+  pointer        next=nullptr,prev=nullptr;
 };
 
 template<typename Bucket>
@@ -61,13 +97,13 @@ private:
   void increment()noexcept
   {
     auto n=std::size_t(boost::core::countr_zero(
-      pbg->bitmask&reset_first_bits((p-pbg->buckets)+1)));
+      pbg->bitmask&reset_first_bits((p-to_raw(pbg->buckets))+1)));
     if(n<N){
-      p=pbg->buckets+n;
+      p=to_raw(pbg->buckets)+n;
     }
     else{
-      pbg=pbg->next;
-      p=pbg->buckets+boost::core::countr_zero(pbg->bitmask);
+      pbg=to_raw(pbg->next);
+      p=to_raw(pbg->buckets)+boost::core::countr_zero(pbg->bitmask);
     }
   }
 
@@ -89,7 +125,8 @@ template<typename Bucket,typename Allocator,typename SizePolicy>
 class grouped_bucket_array
 {
   using size_policy=SizePolicy;
-  using node_type=bucket; // as node is required to derive from bucket
+  using node_type=typename Bucket::bucket_type; // node derives from this
+  using link_pointer=typename node_type::pointer;
 
 public:
   using value_type=Bucket;
@@ -104,9 +141,9 @@ public:
     groups(size_/N+1,al)
   {
     auto pbg=&groups.back();
-    pbg->buckets=&buckets[N*(size_/N)];
+    pbg->buckets=to_pointer<bucket_pointer>(&buckets[N*(size_/N)]);
     pbg->bitmask=set_bit(size_%N);
-    pbg->next=pbg->prev=pbg;
+    pbg->next=pbg->prev=to_pointer<group_pointer>(pbg);
   }
   
   grouped_bucket_array(grouped_bucket_array&&)=default;
@@ -146,27 +183,28 @@ public:
       auto [p,pbg]=itb;
       auto n=p-&buckets[0];
       if(!pbg->bitmask){ // empty group
-        pbg->buckets=&buckets[N*(n/N)];
+        auto ppbg=to_pointer<group_pointer>(pbg);
+        pbg->buckets=to_pointer<bucket_pointer>(&buckets[N*(n/N)]);
         pbg->next=groups.back().next;
-        pbg->next->prev=pbg;
-        pbg->prev=&groups.back();
-        pbg->prev->next=pbg;
+        pbg->next->prev=ppbg;
+        pbg->prev=to_pointer<group_pointer>(&groups.back());
+        pbg->prev->next=ppbg;
       }
       pbg->bitmask|=set_bit(n%N);
     }
     p->next=itb->next;
-    itb->next=p;
+    itb->next=to_pointer<link_pointer>(p);
   }
   
   void extract_node(iterator itb,node_type* p)noexcept
   {
-    node_type** pp=&itb->next;
-    while((*pp)!=p)pp=&(*pp)->next;
+    link_pointer* pp=&itb->next;
+    while(to_raw(*pp)!=p)pp=&(*pp)->next;
     *pp=p->next;
     if(!itb->next)unlink_bucket(itb);
   }
 
-  void extract_node_after(iterator itb,node_type** pp)noexcept
+  void extract_node_after(iterator itb,link_pointer* pp)noexcept
   {
     *pp=(*pp)->next;
     if(!itb->next)unlink_bucket(itb);
@@ -177,12 +215,12 @@ public:
     auto pbg=&groups.front(),last=&groups.back();
     for(;pbg!=last;++pbg){
       for(std::size_t n=0;n<N;++n){
-        if(!pbg->buckets[n].next)pbg->bitmask&=reset_bit(n);
+        if(!to_raw(pbg->buckets)[n].next)pbg->bitmask&=reset_bit(n);
       }
       if(!pbg->bitmask&&pbg->next)unlink_group(pbg);
     }
     for(std::size_t n=0;n<size_%N;++n){ // do not check end bucket
-      if(!pbg->buckets[n].next)pbg->bitmask&=reset_bit(n);
+      if(!to_raw(pbg->buckets)[n].next)pbg->bitmask&=reset_bit(n);
     }
   }
 
@@ -191,6 +229,8 @@ private:
     typename std::allocator_traits<Allocator>::
       template rebind_alloc<value_type>;      
   using group=bucket_group<value_type>;
+  using bucket_pointer=typename group::bucket_pointer;
+  using group_pointer=typename group::pointer;
   using group_allocator_type=
     typename std::allocator_traits<Allocator>::
       template rebind_alloc<group>;
@@ -199,7 +239,7 @@ private:
   void unlink_bucket(iterator itb)
   {
     auto [p,pbg]=itb;
-    if(!(pbg->bitmask&=reset_bit(p-pbg->buckets)))unlink_group(pbg);
+    if(!(pbg->bitmask&=reset_bit(p-to_raw(pbg->buckets))))unlink_group(pbg);
   }
 
   void unlink_group(group* pbg){
@@ -216,6 +256,7 @@ private:
 struct grouped_buckets
 {
   static constexpr bool has_constant_iterator_increment=true;
+  static constexpr bool has_fingerprints=false;
 
   template<typename Bucket,typename Allocator,typename SizePolicy>
   using array_type=grouped_bucket_array<Bucket,Allocator,SizePolicy>;
@@ -246,7 +287,8 @@ class simple_bucket_array
 {
 protected:
   using size_policy=SizePolicy;
-  using node_type=bucket; // as node is required to derive from bucket
+  using node_type=typename Bucket::bucket_type; // node derives from this
+  using link_pointer=typename node_type::pointer;
 
 public:
   using value_type=Bucket;
@@ -259,7 +301,7 @@ public:
     size_(size_policy::size(size_index_)),
     buckets(size_+1,al)
   {
-    buckets.back().next=&buckets.back();
+    buckets.back().next=to_pointer<link_pointer>(&buckets.back());
   }
   
   simple_bucket_array(simple_bucket_array&&)=default;
@@ -288,17 +330,17 @@ public:
   void insert_node(iterator itb,node_type* p)noexcept
   {
     p->next=itb->next;
-    itb->next=p;
+    itb->next=to_pointer<link_pointer>(p);
   }
   
   void extract_node(iterator itb,node_type* p)noexcept
   {
-    node_type** pp=&itb->next;
-    while((*pp)!=p)pp=&(*pp)->next;
+    link_pointer* pp=&itb->next;
+    while(to_raw(*pp)!=p)pp=&(*pp)->next;
     *pp=p->next;
   }
 
-  void extract_node_after(iterator /*itb*/,node_type** pp)noexcept
+  void extract_node_after(iterator /*itb*/,link_pointer* pp)noexcept
   {
     *pp=(*pp)->next;
   }
@@ -317,6 +359,7 @@ private:
 struct simple_buckets
 {
   static constexpr bool has_constant_iterator_increment=false;
+  static constexpr bool has_fingerprints=false;
 
   template<typename Bucket,typename Allocator,typename SizePolicy>
   using array_type=simple_bucket_array<Bucket,Allocator,SizePolicy>;
@@ -328,6 +371,7 @@ class bcached_simple_bucket_array:
 {
   using super=simple_bucket_array<Bucket,Allocator,SizePolicy>;
   using node_type=typename super::node_type;
+  using link_pointer=typename super::link_pointer;
   
 public:
   using iterator=typename super::iterator;
@@ -352,7 +396,7 @@ public:
     adjust_begin(itb);
   }
 
-  void extract_node_after(iterator itb,node_type** pp)noexcept
+  void extract_node_after(iterator itb,link_pointer* pp)noexcept
   {
     super::extract_node_after(itb,pp);
     adjust_begin(itb);
@@ -379,12 +423,140 @@ struct bcached_simple_buckets:simple_buckets
   using array_type=bcached_simple_bucket_array<Bucket,Allocator,SizePolicy>;
 };
 
-template<typename T>
-struct node:bucket
+/* Each bucket is paired with a 16-bit Bloom filter of the hashes of its
+ * chain (two bits per element), so that most unsuccessful lookups are
+ * rejected without touching the bucket or its nodes. Filters are cleared
+ * when their bucket becomes empty and rebuilt on rehashing.
+ */
+template<typename Base>
+class fingerprinted_bucket_array:public Base
+{
+  using node_type=typename Base::value_type::bucket_type;
+  using link_pointer=typename node_type::pointer;
+
+public:
+  using value_type=typename Base::value_type;
+  using size_type=typename Base::size_type;
+  using allocator_type=typename Base::allocator_type;
+  using iterator=typename Base::iterator;
+
+  fingerprinted_bucket_array(size_type n,const allocator_type& al):
+    Base(n,al),
+    fingerprints(Base::capacity()+1,0,fingerprint_allocator_type(al))
+  {}
+
+  fingerprinted_bucket_array(fingerprinted_bucket_array&&)=default;
+  fingerprinted_bucket_array& operator=(fingerprinted_bucket_array&&)=default;
+
+  bool may_contain(size_type pos,std::size_t hash)const noexcept
+  {
+    auto fp=fingerprint(hash);
+    return (fingerprints[pos]&fp)==fp;
+  }
+
+  const void* fingerprint_address(size_type pos)const noexcept
+  {
+    return &fingerprints[pos];
+  }
+
+  void add_fingerprint(size_type pos,std::size_t hash)noexcept
+  {
+    fingerprints[pos]|=fingerprint(hash);
+  }
+
+  void extract_node(iterator itb,node_type* p)noexcept
+  {
+    Base::extract_node(itb,p);
+    if(!itb->next)fingerprints[index_of(itb)]=0;
+  }
+
+  void extract_node_after(iterator itb,link_pointer* pp)noexcept
+  {
+    Base::extract_node_after(itb,pp);
+    if(!itb->next)fingerprints[index_of(itb)]=0;
+  }
+
+private:
+  using fingerprint_allocator_type=
+    typename std::allocator_traits<allocator_type>::
+      template rebind_alloc<std::uint16_t>;
+
+  static std::uint16_t fingerprint(std::size_t hash)noexcept
+  {
+    /* hash may be poorly mixed (boost::hash for integers is the identity) */
+    auto h=static_cast<std::uint64_t>(hash)*0x9E3779B97F4A7C15ull;
+    return static_cast<std::uint16_t>((1u<<(h>>60))|(1u<<((h>>56)&15)));
+  }
+
+  size_type index_of(iterator itb)const noexcept
+  {
+    return static_cast<size_type>(&*itb-&*Base::at(0));
+  }
+
+  std::vector<std::uint16_t,fingerprint_allocator_type> fingerprints;
+};
+
+template<typename BucketArrayPolicy=grouped_buckets>
+struct fingerprinted_buckets:BucketArrayPolicy
+{
+  static constexpr bool has_fingerprints=true;
+
+  template<typename Bucket,typename Allocator,typename SizePolicy>
+  using array_type=fingerprinted_bucket_array<
+    typename BucketArrayPolicy::
+      template array_type<Bucket,Allocator,SizePolicy>>;
+};
+
+template<typename T,typename VoidPointer=void*>
+struct node:basic_bucket<VoidPointer>
 {
   T value;
 };
 
+template<typename T,typename VoidPointer=void*>
+struct hcached_node:basic_bucket<VoidPointer>
+{
+  std::size_t hash;
+  T           value;
+};
+
+struct simple_nodes
+{
+  template<typename T,typename VoidPointer>
+  using node_type=node<T,VoidPointer>;
+
+  template<typename Node,typename Hash>
+  static std::size_t hash(const Node* p,const Hash& h){return h(p->value);}
+  template<typename Node>
+  static void set_hash(Node*,std::size_t){}
+
+  template<typename Key,typename Node,typename Pred>
+  static bool eq(const Key& x,const Node* p,std::size_t /*hash*/,const Pred& pred)
+  {
+    return pred(x,p->value);
+  }
+};
+
+/* the full hash is stored in the node: chain walks compare it before
+ * invoking Pred and rehashing does not call Hash
+ */
+struct hcached_nodes
+{
+  template<typename T,typename VoidPointer>
+  using node_type=hcached_node<T,VoidPointer>;
+
+  template<typename Node,typename Hash>
+  static std::size_t hash(const Node* p,const Hash&){return p->hash;}
+  template<typename Node>
+  static void set_hash(Node* p,std::size_t hash){p->hash=hash;}
+
+  template<typename Key,typename Node,typename Pred>
+  static bool eq(const Key& x,const Node* p,std::size_t hash,const Pred& pred)
+  {
+    return p->hash==hash&&pred(x,p->value);
+  }
+};
+
 template<typename Node,typename Allocator>
 class dynamic_node_allocator
 {
@@ -398,13 +570,13 @@ public:
   template<typename Value,typename RawBucketArray,typename Bucket>
   node_type* new_node(Value&& x,RawBucketArray,Bucket&)
   {  
-    node_type* p=&*alloc_traits::allocate(al,1);
+    node_type* p=to_raw(alloc_traits::allocate(al,1));
     try{
       alloc_traits::construct(al,&p->value,std::forward<Value>(x));
       return p;
     }
     catch(...){
-      alloc_traits::deallocate(al,p,1);
+      alloc_traits::deallocate(al,to_pointer<node_pointer>(p),1);
       throw;
     }
   }
@@ -413,7 +585,7 @@ public:
   void delete_node(node_type* p,RawBucketArray,Bucket&)
   {
     alloc_traits::destroy(al,&p->value);
-    alloc_traits::deallocate(al,p,1);
+    alloc_traits::deallocate(al,to_pointer<node_pointer>(p),1);
   }
   
   template<typename RawBucketArray,typename Bucket>
@@ -424,21 +596,25 @@ public:
 
 protected:
   using alloc_traits=std::allocator_traits<Allocator>;
+  using node_pointer=typename alloc_traits::pointer;
 
   Allocator al; 
 };
 
 struct dynamic_node_allocation
 {
+  static constexpr bool stable_nodes=true; /* not moved on rehash */
+  static constexpr bool bounded_capacity=false;
+
   template<typename Node>
-  using bucket_type=bucket;
+  using bucket_type=typename Node::bucket_type;
   
   template<typename Node,typename Allocator>
   using allocator_type=dynamic_node_allocator<Node,Allocator>;
 };
 
 template<typename Node>
-struct hybrid_node_allocator_bucket:bucket
+struct hybrid_node_allocator_bucket:Node::bucket_type
 {
   hybrid_node_allocator_bucket(){reset_payload();}
 
@@ -447,8 +623,13 @@ struct hybrid_node_allocator_bucket:bucket
   Node& node(){return *data();}
   const Node& value()const{return *data();}
   
-  bool has_payload()const{return data()->next!=data();}
-  void reset_payload(){data()->next=data();}
+  bool has_payload()const{return to_raw(data()->next)!=data();}
+
+  void reset_payload()
+  {
+    data()->next=to_pointer<typename Node::pointer>(
+      static_cast<typename Node::bucket_type*>(data()));
+  }
   
   std::aligned_storage_t<sizeof(Node),alignof(Node)> storage;
 };
@@ -495,7 +676,7 @@ public:
     if(auto pb=find_hosting_bucket(p,buckets)){
       auto newp=new_node_allocator.new_node(
         std::move(pb->data()->value),new_buckets,newb);
-      alloc_traits::destroy(al,&pb->data()->value);
+      alloc_traits::destroy(this->get_allocator(),&pb->data()->value);
       pb->reset_payload();
       return newp;
     }
@@ -536,12 +717,13 @@ private:
     }
     else return (bucket*)nullptr;
   }
-
-  Allocator al; 
 };
 
 struct hybrid_node_allocation
 {
+  static constexpr bool stable_nodes=false;
+  static constexpr bool bounded_capacity=false;
+
   template<typename Node>
   using bucket_type=hybrid_node_allocator_bucket<Node>;
   
@@ -689,8 +871,11 @@ private:
 
 struct linear_node_allocation
 {
+  static constexpr bool stable_nodes=false;
+  static constexpr bool bounded_capacity=true; /* at most one node per bucket */
+
   template<typename Node>
-  using bucket_type=bucket;
+  using bucket_type=typename Node::bucket_type;
   
   template<typename Node,typename Allocator>
   using allocator_type=linear_node_allocator<Node,Allocator>;
@@ -752,11 +937,14 @@ private:
   using size_t_allocator_type=typename alloc_traits::
     template rebind_alloc<std::size_t>;
 
+  using bucket_type=typename node_type::bucket_type;
+  using link_pointer=typename bucket_type::pointer;
+
   node_type* allocate_node()
   {
     if(free){
-      auto p=free;
-      free=static_cast<node_type*>(free->next);
+      auto p=static_cast<node_type*>(to_raw(free));
+      free=p->next;
       return p;
     }
     else{
@@ -767,27 +955,191 @@ private:
   void deallocate_node(node_type* p)
   {
     p->next=free;
-    free=p;
+    free=to_pointer<link_pointer>(static_cast<bucket_type*>(p));
   }
 
   allocator_type                                          al;
   std::size_t                                             top=0;
-  node_type                                               *free=nullptr;
+  link_pointer                                            free=nullptr;
   std::vector<
     uninitialized_node,uninitialized_node_allocator_type> nodes;
 };
 
 struct pool_node_allocation
 {
+  static constexpr bool stable_nodes=false;
+  static constexpr bool bounded_capacity=true;
+
   template<typename Node>
-  using bucket_type=bucket;
+  using bucket_type=typename Node::bucket_type;
   
   template<typename Node,typename Allocator>
   using allocator_type=pool_node_allocator<Node,Allocator>;
 };
 
+/* Nodes are carved from chunks of ChunkSize bytes aligned to their size, so
+ * the chunk of a node is found by masking its address. Each chunk keeps its
+ * own free list; chunks with free slots are linked together and a chunk is
+ * returned to the allocator when it becomes empty (one empty chunk is kept
+ * to avoid thrashing). Nodes never move.
+ */
+template<typename Node,typename Allocator,std::size_t ChunkSize>
+class slab_node_allocator
+{
+  struct chunk;
+  struct chunk_header
+  {
+    chunk        *prev=nullptr,*next=nullptr;
+    Node         *free=nullptr;
+    std::size_t  used=0,top=0;
+  };
+
+  static constexpr std::size_t chunk_size=(std::max)(
+    ChunkSize,
+    boost::core::bit_ceil(sizeof(chunk_header)+8*sizeof(uninitialized<Node>)));
+  static constexpr std::size_t nodes_per_chunk=
+    (chunk_size-sizeof(chunk_header))/sizeof(uninitialized<Node>);
+
+  struct alignas(chunk_size) chunk:chunk_header
+  {
+    uninitialized<Node> nodes[nodes_per_chunk];
+  };
+
+  static_assert(sizeof(chunk)==chunk_size);
+
+public:
+  using allocator_type=Allocator;
+  using node_type=Node;
+  
+  slab_node_allocator(std::size_t /*n*/,const Allocator& al):al{al}{}
+  slab_node_allocator(const slab_node_allocator&)=delete;
+  ~slab_node_allocator(){if(spare)delete_chunk(spare);}
+
+  allocator_type get_allocator(){return al;}
+
+  template<typename Value,typename RawBucketArray,typename Bucket>
+  node_type* new_node(Value&& x,RawBucketArray,Bucket&)
+  {  
+    auto p=allocate_node();
+    try{
+      alloc_traits::construct(al,&p->value,std::forward<Value>(x));
+      return p;
+    }
+    catch(...){
+      deallocate_node(p);
+      throw;
+    }
+  }
+  
+  template<typename RawBucketArray,typename Bucket>
+  void delete_node(node_type* p,RawBucketArray,Bucket&)
+  {
+    alloc_traits::destroy(al,&p->value);
+    deallocate_node(p);
+  }
+  
+  template<typename RawBucketArray,typename Bucket>
+  node_type* relocate_node(
+    node_type* p,RawBucketArray,Bucket&,
+    slab_node_allocator&,RawBucketArray,Bucket&)
+  {return p;}    
+
+private:
+  using alloc_traits=std::allocator_traits<Allocator>;
+  using chunk_allocator_type=typename alloc_traits::
+    template rebind_alloc<chunk>;
+  using chunk_alloc_traits=std::allocator_traits<chunk_allocator_type>;
+  using bucket_type=typename node_type::bucket_type;
+  using link_pointer=typename bucket_type::pointer;
+
+  node_type* allocate_node()
+  {
+    if(!partial){
+      if(spare)partial=std::exchange(spare,nullptr);
+      else partial=new_chunk();
+    }
+
+    auto       c=partial;
+    node_type* p;
+    if(c->free){
+      p=c->free;
+      c->free=static_cast<node_type*>(to_raw(p->next));
+    }
+    else{
+      p=c->nodes[c->top++].data();
+    }
+    if(++c->used==nodes_per_chunk)unlink(c);
+    return p;
+  }
+
+  void deallocate_node(node_type* p)
+  {
+    auto c=reinterpret_cast<chunk*>(
+      reinterpret_cast<std::uintptr_t>(p)&~(chunk_size-1));
+    p->next=to_pointer<link_pointer>(
+      static_cast<bucket_type*>(c->free));
+    c->free=p;
+    if(c->used--==nodes_per_chunk)link(c);
+    if(!c->used){
+      unlink(c);
+      c->free=nullptr;
+      c->top=0;
+      if(spare)delete_chunk(c);
+      else spare=c;
+    }
+  }
+
+  chunk* new_chunk()
+  {
+    chunk_allocator_type cal(al);
+    auto c=to_raw(chunk_alloc_traits::allocate(cal,1));
+    ::new (static_cast<chunk_header*>(c)) chunk_header();
+    return c;
+  }
+
+  void delete_chunk(chunk* c)
+  {
+    chunk_allocator_type cal(al);
+    chunk_alloc_traits::deallocate(
+      cal,to_pointer<typename chunk_alloc_traits::pointer>(c),1);
+  }
+
+  void link(chunk* c)
+  {
+    c->prev=nullptr;
+    c->next=partial;
+    if(partial)partial->prev=c;
+    partial=c;
+  }
+
+  void unlink(chunk* c)
+  {
+    if(c->prev)c->prev->next=c->next;
+    else partial=c->next;
+    if(c->next)c->next->prev=c->prev;
+    c->prev=c->next=nullptr;
+  }
+
+  allocator_type al;
+  chunk          *partial=nullptr, /* chunks with free slots */
+                 *spare=nullptr;
+};
+
+template<std::size_t ChunkSize=4096>
+struct slab_node_allocation
+{
+  static constexpr bool stable_nodes=true;
+  static constexpr bool bounded_capacity=false;
+
+  template<typename Node>
+  using bucket_type=typename Node::bucket_type;
+  
+  template<typename Node,typename Allocator>
+  using allocator_type=slab_node_allocator<Node,Allocator,ChunkSize>;
+};
+
 template<typename Node>
-struct embedded_node_allocator_bucket:bucket
+struct embedded_node_allocator_bucket:Node::bucket_type
 {
   Node* data(){return reinterpret_cast<Node*>(&storage);}
   const Node* data()const{return reinterpret_cast<const Node*>(&storage);}
@@ -867,6 +1219,9 @@ private:
 
 struct embedded_node_allocation
 {
+  static constexpr bool stable_nodes=false;
+  static constexpr bool bounded_capacity=true;
+
   template<typename Node>
   using bucket_type=embedded_node_allocator_bucket<Node>;
   
@@ -874,17 +1229,35 @@ struct embedded_node_allocation
   using allocator_type=embedded_node_allocator<Node,Allocator>;
 };
 
+struct eager_rehash
+{
+  static constexpr bool incremental=false;
+};
+
+/* the old bucket array is kept alongside the new one and its nodes are
+ * migrated on the next growth only, so that insertions below the maximum
+ * load and erasures do not invalidate iterators, as with eager_rehash
+ */
+struct incremental_rehash
+{
+  static constexpr bool incremental=true;
+};
+
 template<
   typename T,typename Hash=boost::hash<T>,typename Pred=std::equal_to<T>,
   typename Allocator=std::allocator<T>,
   typename SizePolicy=prime_size,typename BucketArrayPolicy=grouped_buckets,
-  typename NodeAllocationPolicy=dynamic_node_allocation
+  typename NodeAllocationPolicy=dynamic_node_allocation,
+  typename RehashPolicy=eager_rehash,typename NodePolicy=simple_nodes
 >
 class fca_unordered_set
 {
-  using node_type=node<T>;
+  using node_policy=NodePolicy;
+  using node_type=typename node_policy::template node_type<
+    T,typename std::allocator_traits<Allocator>::void_pointer>;
   using bucket=typename NodeAllocationPolicy::
     template bucket_type<node_type>;
+  using link_pointer=typename node_type::pointer;
   using node_allocator_type=typename NodeAllocationPolicy::
     template allocator_type<
       node_type,
@@ -896,11 +1269,30 @@ class fca_unordered_set
       typename std::allocator_traits<Allocator>::template rebind_alloc<bucket>,
       SizePolicy>;
   using bucket_iterator=typename bucket_array_type::iterator;
+  static constexpr bool has_node_handles=
+    std::is_same_v<NodeAllocationPolicy,dynamic_node_allocation>;
+  static constexpr bool incremental=RehashPolicy::incremental;
+  static_assert(
+    !incremental||NodeAllocationPolicy::stable_nodes,
+    "incremental rehashing requires a NodeAllocationPolicy with stable nodes");
+
+  struct migration_state
+  {
+    std::optional<bucket_array_type> old_buckets;
+  };
+  struct no_migration_state{};
+  struct no_container_pointer
+  {
+    no_container_pointer(const void* =nullptr){}
+  };
+  using container_pointer=std::conditional_t<
+    incremental,const fca_unordered_set*,no_container_pointer>;
     
 public:
   using key_type=T;
   using value_type=T;
   using size_type=std::size_t;
+  using allocator_type=Allocator;
   class const_iterator:public boost::iterator_facade<
     const_iterator,const value_type,boost::forward_traversal_tag>
   {
@@ -911,58 +1303,237 @@ public:
     friend class fca_unordered_set;
     friend class boost::iterator_core_access;
     
-    const_iterator(node_type* p,bucket_iterator itb):p{p},itb{itb}{}
+    const_iterator(
+      node_type* p,bucket_iterator itb,container_pointer c=nullptr):
+      p{p},itb{itb},c{c}{}
 
     const value_type& dereference()const noexcept{return p->value;}
     bool equal(const const_iterator& x)const noexcept{return p==x.p;}
     
     void increment()noexcept
     {
-      if(!(p=static_cast<node_type*>(p->next))){
-        p=static_cast<node_type*>((++itb)->next);
+      if(!(p=static_cast<node_type*>(to_raw(p->next)))){
+        p=static_cast<node_type*>(to_raw((++itb)->next));
+        if constexpr(incremental){
+          /* end of the old bucket array: go on with the new one */
+          if(c&&c->migrating()&&itb==c->migration.old_buckets->end()){
+            itb=c->buckets.begin();
+            p=static_cast<node_type*>(to_raw(itb->next));
+          }
+        }
       }
     }
   
-    node_type       *p=nullptr; 
-    bucket_iterator itb={}; 
+    node_type                               *p=nullptr; 
+    bucket_iterator                         itb={}; 
+    [[no_unique_address]] container_pointer c=nullptr;
   };
   using iterator=const_iterator;
+
+  /* owns a node extracted from the container (dynamic_node_allocation only) */
+  class node_handle
+  {
+  public:
+    node_handle()=default;
+    node_handle(node_handle&& x)noexcept:p{x.p},al{std::move(x.al)}
+    {
+      x.p=nullptr;
+      x.al.reset();
+    }
+    node_handle& operator=(node_handle&& x)noexcept
+    {
+      if(this!=&x){
+        reset();
+        p=x.p;
+        al=std::move(x.al);
+        x.p=nullptr;
+        x.al.reset();
+      }
+      return *this;
+    }
+    ~node_handle(){reset();}
+
+    bool empty()const noexcept{return !p;}
+    explicit operator bool()const noexcept{return p;}
+    value_type& value()const noexcept{return p->value;}
+    allocator_type get_allocator()const{return allocator_type(*al);}
+
+  private:
+    friend class fca_unordered_set;
+
+    using node_alloc_traits=std::allocator_traits<
+      typename std::allocator_traits<Allocator>::
+        template rebind_alloc<node_type>>;
+    using node_allocator=typename node_alloc_traits::allocator_type;
+
+    node_handle(node_type* p,const node_allocator& al):p{p},al{al}{}
+
+    node_type* release()noexcept
+    {
+      auto res=p;
+      p=nullptr;
+      al.reset();
+      return res;
+    }
+
+    void reset()
+    {
+      if(p){
+        node_alloc_traits::destroy(*al,&p->value);
+        node_alloc_traits::deallocate(
+          *al,to_pointer<typename node_alloc_traits::pointer>(p),1);
+        p=nullptr;
+      }
+      al.reset();
+    }
+
+    node_type*                    p=nullptr;
+    std::optional<node_allocator> al;
+  };
+
+  struct insert_return_type
+  {
+    iterator    position;
+    bool        inserted;
+    node_handle node;
+  };
+
+  fca_unordered_set()=default;
+
+  /* Links are allocator pointers, so with fancy pointer allocators
+   * (e.g. Boost.Interprocess) the container can be placed in shared memory.
+   */
+  explicit fca_unordered_set(const Allocator& al):
+    buckets{0,bucket_allocator_type(al)},
+    node_allocator{buckets.capacity(),buckets.get_allocator()}
+  {}
   
   ~fca_unordered_set()
   {
     for(auto first=begin(),last=end();first!=last;)erase(first++);
   }
   
+  /* while migrating, the elements remaining in the old bucket array are
+   * traversed first
+   */
   const_iterator begin()const noexcept
   {
+    if constexpr(incremental){
+      if(migrating()){
+        auto itb=migration.old_buckets->begin();
+        if(itb!=migration.old_buckets->end()){
+          return {static_cast<node_type *>(to_raw(itb->next)),itb,this};
+        }
+      }
+    }
     auto itb=buckets.begin();
-    return {static_cast<node_type *>(itb->next),itb};
+    return {static_cast<node_type *>(to_raw(itb->next)),itb,this};
   }
     
   const_iterator end()const noexcept
   {
     auto itb=buckets.end();
-    return {static_cast<node_type *>(itb->next),itb};
+    return {static_cast<node_type *>(to_raw(itb->next)),itb};
   }
   
   size_type size()const noexcept{return size_;}
+  size_type bucket_count()const noexcept{return buckets.capacity();}
+
+  float load_factor()const noexcept
+  {
+    return static_cast<float>(size_)/static_cast<float>(bucket_count());
+  }
+
+  float max_load_factor()const noexcept{return mlf;}
+
+  /* capped at 1 for node allocation policies with one node per bucket */
+  void max_load_factor(float z)
+  {
+    if(!(z>0.0f)){ /* written so as to catch NaN too */
+      throw std::invalid_argument(
+        "fca_unordered_set: invalid max load factor");
+    }
+    if constexpr(NodeAllocationPolicy::bounded_capacity){
+      if(z>1.0f)z=1.0f;
+    }
+    mlf=z;
+    ml=max_load();
+    if(size_>ml)rehash(size_);
+  }
+
+  void reserve(size_type n)
+  {
+    if(n>ml)rehash(n);
+  }
+
+  allocator_type get_allocator()const
+  {
+    return const_cast<bucket_array_type&>(buckets).get_allocator();
+  }
 
   auto insert(const T& x){return insert_impl(x);}
   auto insert(T&& x){return insert_impl(std::move(x));}
+
+  /* relinks the node, no allocation; nh must come from a container with an
+   * equal allocator
+   */
+  insert_return_type insert(node_handle&& nh)
+  {
+    static_assert(has_node_handles,"dynamic_node_allocation required");
+    if(!nh)return {end(),false,{}};
+    auto hash=node_policy::hash(nh.p,h);
+    auto it=find_hashed(nh.value(),hash);
+    if(it!=end())return {it,false,std::move(nh)};
+    return {link_node(nh.release(),hash),true,{}};
+  }
+
+  node_handle extract(const_iterator pos)
+  {
+    static_assert(has_node_handles,"dynamic_node_allocation required");
+    bucket_array_of(pos.itb).extract_node(pos.itb,pos.p);
+    --size_;
+    return {pos.p,node_allocator.get_allocator()};
+  }
+
+  template<typename Key>
+  node_handle extract(const Key& x)
+  {
+    auto it=find(x);
+    if(it==end())return {};
+    return extract(it);
+  }
+
+  /* moves the elements of x whose keys are not in *this by relinking their
+   * nodes; allocators must compare equal
+   */
+  void merge(fca_unordered_set& x)
+  {
+    static_assert(has_node_handles,"dynamic_node_allocation required");
+    if(this==&x)return;
+    for(auto first=x.begin(),last=x.end();first!=last;){
+      auto pos=first++;
+      auto hash=node_policy::hash(pos.p,h);
+      if(find_hashed(*pos,hash)!=end())continue;
+      x.bucket_array_of(pos.itb).extract_node(pos.itb,pos.p);
+      --x.size_;
+      link_node(pos.p,hash);
+    }
+  }
   
   auto erase(const_iterator pos)
   {
+    auto p=pos.p;
+    auto itb=pos.itb;
+    auto& bucks=bucket_array_of(itb);
     if constexpr(BucketArrayPolicy::has_constant_iterator_increment){
-      auto [p,itb]=pos;
       ++pos;
-      buckets.extract_node(itb,p);
+      bucks.extract_node(itb,p);
       node_allocator.delete_node(p,buckets.raw(),*itb);
       --size_;
       return pos;
     }
     else{
-      auto [p,itb]=pos;
-      buckets.extract_node(itb,p);
+      bucks.extract_node(itb,p);
       delete_node(p,*itb);
       --size_;
     }
@@ -971,23 +1542,57 @@ public:
   template<typename Key>
   size_type erase(const Key& x)
   {
-    auto [pp,itb]=find_prev(x);
-    if(!pp){
-      return 0;
-    }
-    else{
-      auto p=*pp;
-      buckets.extract_node_after(itb,pp);
-      delete_node(static_cast<node_type*>(p),*itb);
-      --size_;
-      return 1;
+    auto hash=h(x);
+    if(erase(x,hash,buckets,buckets.position(hash)))return 1;
+    if constexpr(incremental){
+      if(migrating()){
+        auto& old_buckets=*migration.old_buckets;
+        if(erase(x,hash,old_buckets,old_buckets.position(hash)))return 1;
+      }
     }
+    return 0;
   }
 
   template<typename Key>
   iterator find(const Key& x)const
   {
-    return find(x,buckets.at(buckets.position(h(x))));
+    return find_hashed(x,h(x));
+  }
+
+  /* Writes find(x) to out for each x in keys. Keys are processed in
+   * batches: bucket positions are computed and the buckets prefetched for
+   * the whole batch, then the first node of every bucket is prefetched,
+   * and only then are the chains walked, so that the dependent loads of
+   * different lookups overlap.
+   */
+  template<typename Keys,typename OutputIterator>
+  OutputIterator find_many(const Keys& keys,OutputIterator out)const
+  {
+    static constexpr std::size_t batch_size=16;
+
+    std::size_t hashes[batch_size],positions[batch_size];
+    auto        first=std::begin(keys);
+    auto        last=std::end(keys);
+    while(first!=last){
+      auto        batch_first=first;
+      std::size_t n=0;
+      for(;n<batch_size&&first!=last;++n,++first){
+        hashes[n]=h(*first);
+        positions[n]=buckets.position(hashes[n]);
+        if constexpr(BucketArrayPolicy::has_fingerprints){
+          prefetch(buckets.fingerprint_address(positions[n]));
+        }
+        prefetch(&*buckets.at(positions[n]));
+      }
+      for(std::size_t i=0;i<n;++i){
+        if(!may_contain(buckets,positions[i],hashes[i]))continue;
+        if(auto p=to_raw(buckets.at(positions[i])->next))prefetch(p);
+      }
+      for(std::size_t i=0;i<n;++i,++batch_first){
+        *out++=find_hashed(*batch_first,hashes[i]);
+      }
+    }
+    return out;
   }
 
 private:
@@ -1006,10 +1611,14 @@ private:
     node_type* p,bucket& b,
     node_allocator_type& new_node_allocator,bucket_array_type& new_buckets)
   {
-    auto itnewb=new_buckets.at(new_buckets.position(h(p->value)));
+    auto hash=node_policy::hash(p,h);
+    auto pos=new_buckets.position(hash);
+    auto itnewb=new_buckets.at(pos);
     p=node_allocator.relocate_node(
       p,buckets.raw(),b,
       new_node_allocator,new_buckets.raw(),*itnewb);
+    node_policy::set_hash(p,hash);
+    add_fingerprint(new_buckets,pos,hash);
     new_buckets.insert_node(itnewb,p);
   }
 
@@ -1017,19 +1626,36 @@ private:
   std::pair<iterator,bool> insert_impl(Value&& x)
   {
     auto hash=h(x);
-    auto itb=buckets.at(buckets.position(hash));
-    auto it=find(x,itb);
+    auto it=find_hashed(x,hash);
     if(it!=end())return {it,false};
         
+    reserve_for_insert();
+    auto pos=buckets.position(hash);
+    auto itb=buckets.at(pos);
+    auto p=new_node(std::forward<Value>(x),*itb);
+    node_policy::set_hash(p,hash);
+    add_fingerprint(buckets,pos,hash);
+    buckets.insert_node(itb,p);
+    ++size_;
+    return {{p,itb,this},true};
+  }
+
+  void reserve_for_insert()
+  {
     if(BOOST_UNLIKELY(size_+1>ml)){
       rehash(size_+1);
-      itb=buckets.at(buckets.position(hash));
     }
-    
-    auto p=new_node(std::forward<Value>(x),*itb);
+  }
+
+  iterator link_node(node_type* p,std::size_t hash)
+  {
+    reserve_for_insert();
+    auto pos=buckets.position(hash);
+    auto itb=buckets.at(pos);
+    add_fingerprint(buckets,pos,hash);
     buckets.insert_node(itb,p);
     ++size_;
-    return {{p,itb},true};
+    return {p,itb,this};
   }
 
   void rehash(size_type n)
@@ -1038,22 +1664,35 @@ private:
     float       fbc=1.0f+static_cast<float>(n)/mlf;
     if(bc>fbc)bc=static_cast<std::size_t>(fbc);
 
+    if constexpr(incremental){
+      /* nodes of the previous old array are relinked now, those of the
+       * current array on the next growth
+       */
+      if(migrating())migrate();
+      bucket_array_type new_buckets(bc,buckets.get_allocator());
+      migration.old_buckets.emplace(std::move(buckets));
+      buckets=std::move(new_buckets);
+      ml=max_load();
+      return;
+    }
+
     bucket_array_type   new_buckets(bc,buckets.get_allocator());
     node_allocator_type new_node_allocator(
                           new_buckets.capacity(),new_buckets.get_allocator());
     try{
       for(auto& b:buckets.raw()){            
-        for(auto p=b.next;p;){
+        for(auto p=to_raw(b.next);p;){
           auto  next_p=p->next;
           transfer_node(static_cast<node_type*>(p),b,new_node_allocator,new_buckets);
-          b.next=p=next_p;
+          b.next=next_p;
+          p=to_raw(next_p);
         }
       }
     }
     catch(...){
       for(auto& b:new_buckets){
-        for(auto p=b.next;p;){
-          auto next_p=p->next;
+        for(auto p=to_raw(b.next);p;){
+          auto next_p=to_raw(p->next);
           delete_node(static_cast<node_type*>(p),b);
           --size_;
           p=next_p;
@@ -1063,32 +1702,122 @@ private:
       throw;
     }
     buckets=std::move(new_buckets);
-    node_allocator=std::move(new_node_allocator);
+    if constexpr(!NodeAllocationPolicy::stable_nodes){
+      /* stateful allocators such as Boost.Interprocess's are not assignable */
+      node_allocator.~node_allocator_type();
+      ::new (&node_allocator) node_allocator_type(std::move(new_node_allocator));
+    }
     ml=max_load();   
   }
+
+  bool migrating()const noexcept
+  {
+    if constexpr(incremental)return migration.old_buckets.has_value();
+    else return false;
+  }
+
+  /* moves the nodes of the old buckets to the new array */
+  void migrate()
+  {
+    auto& old_buckets=*migration.old_buckets;
+    for(std::size_t i=0,last=old_buckets.capacity();i<last;++i){
+      auto itb=old_buckets.at(i);
+      while(auto p=static_cast<node_type*>(to_raw(itb->next))){
+        auto hash=node_policy::hash(p,h);
+        auto pos=buckets.position(hash);
+        old_buckets.extract_node(itb,p);
+        add_fingerprint(buckets,pos,hash);
+        buckets.insert_node(buckets.at(pos),p);
+      }
+    }
+    migration.old_buckets.reset();
+  }
+
+  bucket_array_type& bucket_array_of(bucket_iterator itb)
+  {
+    if constexpr(incremental){
+      if(migrating()){
+        auto& old_buckets=*migration.old_buckets;
+        if(&*old_buckets.at(0)<=&*itb&&
+           &*itb<=&*old_buckets.at(old_buckets.capacity())){
+          return old_buckets;
+        }
+      }
+    }
+    return buckets;
+  }
+
+  template<typename Key>
+  iterator find_hashed(const Key& x,std::size_t hash)const
+  {
+    auto it=find(x,hash,buckets,buckets.position(hash));
+    if constexpr(incremental){
+      if(it==end()&&migrating()){
+        auto& old_buckets=*migration.old_buckets;
+        it=find(x,hash,old_buckets,old_buckets.position(hash));
+      }
+    }
+    return it;
+  }
   
   template<typename Key>
-  iterator find(const Key& x,bucket_iterator itb)const
+  iterator find(
+    const Key& x,std::size_t hash,
+    const bucket_array_type& bucks,std::size_t pos)const
   {
-    for(auto p=itb->next;p;p=p->next){
-      if(BOOST_LIKELY(pred(x,static_cast<node_type*>(p)->value))){
-        return {static_cast<node_type*>(p),itb};
+    if(!may_contain(bucks,pos,hash))return end();
+    auto itb=bucks.at(pos);
+    for(auto p=to_raw(itb->next);p;p=to_raw(p->next)){
+      if(BOOST_LIKELY(
+        node_policy::eq(x,static_cast<node_type*>(p),hash,pred))){
+        return {static_cast<node_type*>(p),itb,this};
       }
     }
     return end();
   }
-  
+
   template<typename Key>
-  std::pair<fxa_unordered::bucket**,bucket_iterator>
-  find_prev(const Key& x)const
+  bool erase(
+    const Key& x,std::size_t hash,bucket_array_type& bucks,std::size_t pos)
   {
-    auto itb=buckets.at(buckets.position(h(x)));
-    for(auto pp=&itb->next;*pp;pp=&(*pp)->next){
-      if(BOOST_LIKELY(pred(x,static_cast<node_type*>(*pp)->value))){
-        return {pp,itb};
+    if(!may_contain(bucks,pos,hash))return false;
+    auto itb=bucks.at(pos);
+    for(auto pp=&itb->next;*pp;pp=&to_raw(*pp)->next){
+      auto p=static_cast<node_type*>(to_raw(*pp));
+      if(BOOST_LIKELY(node_policy::eq(x,p,hash,pred))){
+        bucks.extract_node_after(itb,pp);
+        delete_node(p,*itb);
+        --size_;
+        return true;
       }
     }
-    return {nullptr,{}};
+    return false;
+  }
+     
+  static void prefetch(const void* p)
+  {
+#if defined(BOOST_GCC)||defined(BOOST_CLANG)
+    __builtin_prefetch((const char*)p);
+#elif defined(FXA_UNORDERED_SSE2)
+    _mm_prefetch((const char*)p,_MM_HINT_T0);
+#endif
+  }
+
+  static bool may_contain(
+    const bucket_array_type& bucks,std::size_t pos,std::size_t hash)
+  {
+    if constexpr(BucketArrayPolicy::has_fingerprints){
+      return bucks.may_contain(pos,hash);
+    }
+    else return true;
+  }
+
+  static void add_fingerprint(
+    bucket_array_type& bucks,std::size_t pos,std::size_t hash)
+  {
+    if constexpr(BucketArrayPolicy::has_fingerprints){
+      bucks.add_fingerprint(pos,hash);
+    }
   }
      
   size_type max_load()const
@@ -1099,14 +1828,21 @@ private:
     return res;
   }  
 
-  Hash                h;
-  Pred                pred;
-  float               mlf=1.0f;
-  size_type           size_=0;
-  bucket_array_type   buckets{0,Allocator()};
-  node_allocator_type node_allocator{
-                        buckets.capacity(),buckets.get_allocator()};
-  size_type           ml=max_load();  
+  using bucket_allocator_type=
+    typename std::allocator_traits<Allocator>::template rebind_alloc<bucket>;
+  using migration_state_type=std::conditional_t<
+    incremental,migration_state,no_migration_state>;
+
+  Hash                                       h;
+  Pred                                       pred;
+  float                                      mlf=1.0f;
+  size_type                                  size_=0;
+  bucket_array_type                          buckets{
+                                               0,bucket_allocator_type(Allocator())};
+  node_allocator_type                        node_allocator{
+                                               buckets.capacity(),buckets.get_allocator()};
+  size_type                                  ml=max_load();  
+  [[no_unique_address]] migration_state_type migration;
 };
 
 template<
@@ -1114,12 +1850,14 @@ template<
   typename Hash=boost::hash<Key>,typename Pred=std::equal_to<Key>,
   typename Allocator=std::allocator<map_value_adaptor<Key,Value>>,
   typename SizePolicy=prime_size,typename BucketArrayPolicy=grouped_buckets,
-  typename NodeAllocationPolicy=dynamic_node_allocation
+  typename NodeAllocationPolicy=dynamic_node_allocation,
+  typename RehashPolicy=eager_rehash,typename NodePolicy=simple_nodes
 >
 using fca_unordered_map=fca_unordered_set<
   map_value_adaptor<Key,Value>,
   map_hash_adaptor<Hash>,map_pred_adaptor<Pred>,
-  Allocator,SizePolicy,BucketArrayPolicy,NodeAllocationPolicy
+  Allocator,SizePolicy,BucketArrayPolicy,NodeAllocationPolicy,RehashPolicy,
+  NodePolicy
 >;
 
 } // namespace fxa_unordered
@@ -0,0 +1,175 @@
+// Copyright 2022 Joaquin M Lopez Munoz.
+// Distributed under the Boost Software License, Version 1.0.
+// https://www.boost.org/LICENSE_1_0.txt
+
+#include <boost/algorithm/minmax_element.hpp>
+#include <boost/unordered/unordered_flat_set.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "container_defs.hpp"
+#include "foa_rc_filter.hpp"
+
+using namespace std::chrono_literals;
+
+static void print_time( std::chrono::steady_clock::time_point & t1, char const* label, std::uint64_t s, std::size_t size )
+{
+    auto t2 = std::chrono::steady_clock::now();
+
+    std::cout << label << ": " << ( t2 - t1 ) / 1ms << " ms (s=" << s << ", size=" << size << ")\n";
+
+    t1 = t2;
+}
+
+// N hashes inserted into foa_rc_filter and into an exact set of hashes,
+// then looked up along with N hashes never inserted: for the filter, s
+// in "Insert" is the number of failed insertions and s in "Absent lookup"
+// the number of false positives
+
+constexpr unsigned N = 2'000'000;
+constexpr int K = 10;
+
+static std::vector< std::uint64_t > indices;
+
+static void init_indices()
+{
+    indices.push_back( 0 );
+
+    boost::detail::splitmix64 rng;
+
+    for( unsigned i = 1; i <= N*2; ++i )
+    {
+        indices.push_back( rng() );
+    }
+}
+
+using rc_filter = fxa_unordered::rc::foa_rc_filter< ::allocator<fxa_unordered::rc::group15> >;
+
+using flat_set = boost::unordered_flat_set<
+  std::uint64_t, mulx_hash<std::uint64_t>, std::equal_to<std::uint64_t>, ::allocator<std::uint64_t> >;
+
+static bool insert( rc_filter& f, std::uint64_t x ) { return f.insert( x ); }
+static bool insert( flat_set& s, std::uint64_t x ) { s.insert( x ); return true; }
+
+static bool contains( rc_filter const& f, std::uint64_t x ) { return f.maybe_contains( x ); }
+static bool contains( flat_set const& s, std::uint64_t x ) { return s.find( x ) != s.end(); }
+
+template<class Set> void BOOST_NOINLINE test_insert( Set& set, std::chrono::steady_clock::time_point & t1 )
+{
+    std::uint64_t s = 0;
+
+    for( unsigned i = 1; i <= N; ++i )
+    {
+        if( !insert( set, indices[ i ] ) ) ++s;
+    }
+
+    print_time( t1, "Insert",  s, set.size() );
+}
+
+template<class Set> void BOOST_NOINLINE test_lookup( Set& set, std::chrono::steady_clock::time_point & t1 )
+{
+    std::uint64_t s = 0;
+
+    for( int j = 0; j < K; ++j )
+    {
+        for( unsigned i = 1; i <= N; ++i )
+        {
+            s += contains( set, indices[ i ] );
+        }
+    }
+
+    print_time( t1, "Present lookup",  s, set.size() );
+
+    s = 0;
+
+    for( int j = 0; j < K; ++j )
+    {
+        for( unsigned i = N + 1; i <= N * 2; ++i )
+        {
+            s += contains( set, indices[ i ] );
+        }
+    }
+
+    print_time( t1, "Absent lookup",  s / K, set.size() );
+}
+
+template<class Set> void BOOST_NOINLINE test_erase( Set& set, std::chrono::steady_clock::time_point & t1 )
+{
+    for( unsigned i = 1; i <= N; ++i )
+    {
+        set.erase( indices[ i ] );
+    }
+
+    print_time( t1, "Erase",  0, set.size() );
+
+    std::cout << std::endl;
+}
+
+//
+
+struct record
+{
+    std::string label_;
+    long long time_;
+    std::size_t bytes_;
+};
+
+static std::vector<record> times;
+
+template<class Set, class MakeSet> void BOOST_NOINLINE test( char const* label, MakeSet make_set )
+{
+    std::cout << label << ":\n\n";
+
+    s_alloc_bytes = 0;
+    s_alloc_count = 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    auto t1 = t0;
+    std::size_t bytes = 0;
+
+    {
+        Set set = make_set();
+
+        test_insert( set, t1 );
+
+        bytes = s_alloc_bytes;
+
+        test_lookup( set, t1 );
+        test_erase( set, t1 );
+    }
+
+    auto tN = std::chrono::steady_clock::now();
+
+    std::cout << "Memory: " << bytes << " bytes\n\n";
+    std::cout << "Total: " << ( tN - t0 ) / 1ms << " ms\n\n";
+
+    times.push_back( { label, ( tN - t0 ) / 1ms, bytes } );
+}
+
+int main()
+{
+    init_indices();
+
+    test<flat_set>( "boost::unordered_flat_set", []{ return flat_set(); } );
+    test<rc_filter>( "foa_rc_filter", []{ return rc_filter( N ); } );
+
+    std::cout << "---\n\n";
+
+    int label_witdh = 0;
+    for( auto const& x: times ) label_witdh = (std::max)((int)( x.label_ + ": " ).size(), label_witdh);
+
+    for (auto const& x : times)
+    {
+        std::cout << std::setw(label_witdh) << (x.label_ + ": ") <<
+        std::setw( 5 ) << x.time_ << " ms, " <<
+        std::setw( 9 ) << x.bytes_ << " bytes\n";
+    }
+
+    auto [pmint, pmaxt] = boost::minmax_element(
+        times.begin(), times.end(), [](const record& x, const record& y){ return x.time_< y.time_; });
+
+    std::cout << "\n" << std::setw( 28 ) << "Time(worst)/time(best): " << (float)(pmaxt->time_) / pmint->time_ << "\n\n";
+}
@@ -0,0 +1,291 @@
+/* Proof of concept of closed- and open-addressing
+ * unordered associative containers.
+ *
+ * Copyright 2022 Joaquin M Lopez Munoz.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef FOA_RC_CACHE_HPP
+#define FOA_RC_CACHE_HPP
+
+#include <boost/config.hpp>
+#include <boost/container_hash/hash.hpp>
+#include <boost/core/bit.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "fxa_common.hpp"
+#include "foa_unordered_rc.hpp"
+
+namespace fxa_unordered{
+
+namespace rc{
+
+/* Fixed-capacity cache on top of the rc group layout. Each key can only
+ * live in its home group (the cache is N-way set associative), so lookup
+ * inspects exactly one group and the table is never rehashed. When the
+ * home group is full, insertion evicts one of its elements following
+ * the CLOCK (second chance) algorithm: each group has a side word with
+ * a reference bit per slot, set on every hit, and a clock hand.
+ */
+
+template<
+  typename Key,typename Value,
+  typename Hash=boost::hash<Key>,typename Pred=std::equal_to<Key>,
+  typename Allocator=std::allocator<map_value_adaptor<Key,Value>>,
+  typename Group=group15,
+  typename SizePolicy=pow2_size,
+  typename HashSplitPolicy=shift_hash<0>
+>
+class foa_rc_cache
+{
+  using size_policy=SizePolicy;
+  using hash_split_policy=HashSplitPolicy;
+  using alloc_traits=std::allocator_traits<Allocator>;
+  using group_type=Group;
+  using element_type=element<map_value_adaptor<Key,Value>>;
+  static constexpr auto N=group_type::N;
+
+  struct clock_state
+  {
+    std::uint16_t refs=0;
+    std::uint8_t  hand=0;
+  };
+
+  using group_vector=std::vector<
+    group_type,typename alloc_traits::template rebind_alloc<group_type>>;
+  using element_vector=std::vector<
+    element_type,typename alloc_traits::template rebind_alloc<element_type>>;
+  using clock_vector=std::vector<
+    clock_state,typename alloc_traits::template rebind_alloc<clock_state>>;
+
+public:
+  using key_type=Key;
+  using mapped_type=Value;
+  using value_type=map_value_adaptor<Key,Value>;
+  using size_type=std::size_t;
+
+  /* the number of groups is the size SizePolicy picks for capacity/N
+   * rounded up, a power of two for pow2_size, so actual capacity can be
+   * up to twice as large: foa_rc_cache(1000) holds 128*15=1920 elements.
+   * No group is reserved for a sentinel, so a cache constructed with the
+   * capacity() of another one gets the same capacity.
+   */
+  explicit foa_rc_cache(
+    std::size_t capacity,const Hash& h=Hash(),const Pred& pred=Pred(),
+    const Allocator& al=Allocator()):
+    h{h},pred{pred},al{al},
+    group_size_index{size_policy::size_index((capacity+N-1)/N)},
+    groups{size_policy::size(group_size_index),al},
+    elements{groups.size()*N,al},
+    clocks{groups.size(),al}
+  {}
+
+  foa_rc_cache(const foa_rc_cache&)=delete;
+  foa_rc_cache& operator=(const foa_rc_cache&)=delete;
+
+  ~foa_rc_cache(){destroy_elements();}
+
+  size_type size()const noexcept{return size_;}
+  size_type capacity()const noexcept{return groups.size()*N;}
+
+  float load_factor()const noexcept
+  {
+    return static_cast<float>(size_)/static_cast<float>(capacity());
+  }
+
+  /* nullptr on a miss; a hit marks the element as recently used */
+  template<typename K>
+  BOOST_FORCEINLINE mapped_type* find(const K& x)
+  {
+    auto [pos,n]=find_slot(x);
+    if(pos==npos)return nullptr;
+    clocks[pos].refs|=std::uint16_t(1u<<n);
+    return &elements[pos*N+n].value().second;
+  }
+
+  /* returns true if x was not present; the element evicted to make room
+   * for x, if any, is passed to on_evict
+   */
+  template<typename K,typename V,typename F>
+  bool insert_or_assign(K&& x,V&& v,F on_evict)
+  {
+    auto hash=h(x);
+    auto pos=position_for(hash_split_policy::long_hash(hash));
+    auto short_hash=hash_split_policy::short_hash(hash);
+    auto pg=groups.data()+pos;
+    auto pe=elements.data()+pos*N;
+    auto& clock=clocks[pos];
+
+    auto n=find_in_group(x,pg,pe,short_hash);
+    if(n!=npos){
+      pe[n].value().second=std::forward<V>(v);
+      clock.refs|=std::uint16_t(1u<<n);
+      return false;
+    }
+
+    if(auto mask=pg->match_available()){
+      n=(std::size_t)unchecked_countr_zero((unsigned int)mask);
+      ++size_;
+    }
+    else{
+      n=evict(clock);
+      on_evict(std::move(pe[n].value()));
+      destroy_element(pe[n].data());
+      pg->reset(n);
+    }
+    try{
+      alloc_traits::construct(
+        al,pe[n].data(),std::forward<K>(x),std::forward<V>(v));
+    }
+    catch(...){
+      clock.refs&=std::uint16_t(~(1u<<n));
+      --size_;
+      throw;
+    }
+    pg->set(n,short_hash);
+    clock.refs|=std::uint16_t(1u<<n);
+    return true;
+  }
+
+  template<typename K,typename V>
+  bool insert_or_assign(K&& x,V&& v)
+  {
+    return insert_or_assign(
+      std::forward<K>(x),std::forward<V>(v),[](value_type&&){});
+  }
+
+  template<typename K>
+  size_type erase(const K& x)
+  {
+    auto [pos,n]=find_slot(x);
+    if(pos==npos)return 0;
+    destroy_element(elements[pos*N+n].data());
+    groups[pos].reset(n);
+    clocks[pos].refs&=std::uint16_t(~(1u<<n));
+    --size_;
+    return 1;
+  }
+
+  void clear()noexcept
+  {
+    destroy_elements();
+    std::fill(groups.begin(),groups.end(),group_type{});
+    std::fill(clocks.begin(),clocks.end(),clock_state{});
+    size_=0;
+  }
+
+  template<typename F>
+  void for_each(F f)const
+  {
+    for(std::size_t pos=0,last=groups.size();pos!=last;++pos){
+      auto mask=groups[pos].match_really_occupied();
+      while(mask){
+        auto n=unchecked_countr_zero((unsigned int)mask);
+        f(static_cast<const value_type&>(elements[pos*N+n].value()));
+        mask&=mask-1;
+      }
+    }
+  }
+
+private:
+  static constexpr std::size_t npos=(std::numeric_limits<std::size_t>::max)();
+  static constexpr unsigned    full_mask=(1u<<N)-1;
+
+  std::size_t position_for(std::size_t hash)const
+  {
+    return size_policy::position(hash,group_size_index);
+  }
+
+  template<typename K>
+  BOOST_FORCEINLINE std::size_t find_in_group(
+    const K& x,const group_type* pg,const element_type* pe,
+    std::size_t short_hash)const
+  {
+    auto mask=pg->match(short_hash);
+    while(mask){
+      auto n=unchecked_countr_zero((unsigned int)mask);
+      if(BOOST_LIKELY(pred(x,pe[n].value().first)))return (std::size_t)n;
+      mask&=mask-1;
+    }
+    return npos;
+  }
+
+  /* returns {group,slot} or {npos,_} */
+  template<typename K>
+  BOOST_FORCEINLINE std::pair<std::size_t,std::size_t> find_slot(
+    const K& x)const
+  {
+    auto hash=h(x);
+    auto pos=position_for(hash_split_policy::long_hash(hash));
+    auto n=find_in_group(
+      x,groups.data()+pos,elements.data()+pos*N,
+      hash_split_policy::short_hash(hash));
+    return {n!=npos?pos:npos,n};
+  }
+
+  /* CLOCK over a full group, bit-parallel: the victim is the first slot
+   * from the hand on with its reference bit unset, and the reference
+   * bits of the slots swept over on the way are cleared
+   */
+  static std::size_t evict(clock_state& clock)
+  {
+    unsigned hand=clock.hand,
+             cand=~(unsigned)clock.refs&full_mask;
+    if(!cand){ /* full sweep: all get their second chance */
+      clock.refs=0;
+      cand=full_mask;
+    }
+    auto     rot=((cand>>hand)|(cand<<(N-hand)))&full_mask;
+    unsigned n=(hand+(unsigned)unchecked_countr_zero(rot))%N;
+    auto     swept=n>=hand?
+                     ((1u<<n)-1)&~((1u<<hand)-1):
+                     (((1u<<n)-1)|~((1u<<hand)-1))&full_mask;
+    clock.refs&=std::uint16_t(~swept);
+    clock.hand=std::uint8_t((n+1)%N);
+    return n;
+  }
+
+  void destroy_element(value_type* p)
+  {
+    alloc_traits::destroy(al,p);
+  }
+
+  void destroy_elements()
+  {
+    if constexpr(!std::is_trivially_destructible_v<value_type>){
+      for(std::size_t pos=0,last=groups.size();pos!=last;++pos){
+        auto mask=groups[pos].match_really_occupied();
+        while(mask){
+          auto n=unchecked_countr_zero((unsigned int)mask);
+          destroy_element(elements[pos*N+n].data());
+          mask&=mask-1;
+        }
+      }
+    }
+  }
+
+  Hash           h;
+  Pred           pred;
+  Allocator      al;
+  std::size_t    size_=0;
+  std::size_t    group_size_index;
+  group_vector   groups;
+  element_vector elements;
+  clock_vector   clocks;
+};
+
+} // namespace rc
+
+} // namespace fxa_unordered
+
+using fxa_unordered::rc::foa_rc_cache;
+
+#endif
@@ -0,0 +1,205 @@
+/* Proof of concept of closed- and open-addressing
+ * unordered associative containers.
+ *
+ * Copyright 2022 Joaquin M Lopez Munoz.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef FOA_RC_FILTER_HPP
+#define FOA_RC_FILTER_HPP
+
+#include <boost/config.hpp>
+#include <boost/core/bit.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "fxa_common.hpp"
+#include "foa_unordered_rc.hpp"
+
+namespace fxa_unordered{
+
+namespace rc{
+
+/* Approximate membership filter made of group15 metadata alone: each
+ * entry is the 8-bit reduced hash rc would store in its control byte,
+ * and there is no element array. Entries are laid out as in a cuckoo
+ * filter with 15-slot buckets: a fingerprint f with home group i can
+ * also live in group i^alt(f), so both candidate groups of any
+ * fingerprint found in group j are {j,j^alt(f)}. This makes erasure
+ * exact (removing any copy of f from either group is equivalent) and
+ * allows entries to be kicked to their other group when both are full.
+ * Lookup is two SIMD group matches.
+ */
+
+template<
+  typename Allocator=std::allocator<group15>,
+  typename HashSplitPolicy=shift_hash<0>
+>
+class foa_rc_filter
+{
+  using size_policy=pow2_size; /* alt(f) relies on xor within a power of 2 */
+  using hash_split_policy=HashSplitPolicy;
+  using group_type=group15;
+  using alloc_traits=std::allocator_traits<Allocator>;
+  using group_vector=std::vector<
+    group_type,typename alloc_traits::template rebind_alloc<group_type>>;
+  static constexpr auto N=group_type::N;
+
+public:
+  using size_type=std::size_t;
+
+  /* sized for capacity entries with ~5% slack (and a power of two number
+   * of groups); insert starts failing at ~99% occupancy of capacity()
+   */
+  explicit foa_rc_filter(
+    std::size_t capacity,const Allocator& al=Allocator()):
+    group_size_index{size_policy::size_index(capacity*20/19/N+1)},
+    groups{size_policy::size(group_size_index),al}
+  {}
+
+  size_type size()const noexcept{return size_;}
+  size_type capacity()const noexcept{return groups.size()*N;}
+
+  float load_factor()const noexcept
+  {
+    return static_cast<float>(size_)/static_cast<float>(capacity());
+  }
+
+  /* false if the filter is full, in which case hash is not added */
+  bool insert(std::size_t hash)
+  {
+    if(victim.used)return false;
+
+    auto f=fingerprint(hash);
+    auto pos=position_for(hash);
+    auto pos2=pos^alt(f);
+    ++size_;
+    if(try_set(pos,f)||try_set(pos2,f))return true;
+
+    /* both groups full: kick a random entry to its other group */
+    if(rng&1)pos=pos2;
+    for(int kicks=0;kicks<max_kicks;++kicks){
+      auto n=next_random()%N;
+      auto& g=groups[pos];
+      auto f2=g.stored_hash(n);
+      g.set(n,f);
+      f=f2;
+      pos^=alt(f);
+      if(try_set(pos,f))return true;
+    }
+
+    /* give up; the last kicked entry is kept aside so that nothing is lost */
+    victim={true,pos,f};
+    return true;
+  }
+
+  bool maybe_contains(std::size_t hash)const
+  {
+    auto f=fingerprint(hash);
+    auto pos=position_for(hash);
+    auto pos2=pos^alt(f);
+    return
+      groups[pos].match(f)||groups[pos2].match(f)||
+      (victim.used&&victim.f==f&&(victim.pos==pos||victim.pos==pos2));
+  }
+
+  /* only to be called for hashes previously inserted, else other
+   * entries with the same fingerprint could get removed
+   */
+  bool erase(std::size_t hash)
+  {
+    auto f=fingerprint(hash);
+    auto pos=position_for(hash);
+    auto pos2=pos^alt(f);
+    if(victim.used&&victim.f==f&&(victim.pos==pos||victim.pos==pos2)){
+      victim.used=false;
+      --size_;
+      return true;
+    }
+    if(!(try_reset(pos,f)||try_reset(pos2,f)))return false;
+    --size_;
+    if(victim.used&&    /* room may have been made for the entry kept aside */
+       (try_set(victim.pos,victim.f)||
+        try_set(victim.pos^alt(victim.f),victim.f))){
+      victim.used=false;
+    }
+    return true;
+  }
+
+  void clear()noexcept
+  {
+    std::fill(groups.begin(),groups.end(),group_type{});
+    victim.used=false;
+    size_=0;
+  }
+
+private:
+  static constexpr int max_kicks=500;
+
+  struct victim_type
+  {
+    bool          used=false;
+    std::size_t   pos=0;
+    unsigned char f=0;
+  };
+
+  /* canonical fingerprint: the byte group15 stores for hash */
+  static unsigned char fingerprint(std::size_t hash)
+  {
+    return adjust_hash_table[
+      (unsigned char)hash_split_policy::short_hash(hash)];
+  }
+
+  std::size_t position_for(std::size_t hash)const
+  {
+    return size_policy::position(
+      hash_split_policy::long_hash(hash),group_size_index);
+  }
+
+  std::size_t alt(unsigned char f)const
+  {
+    return ((std::size_t)f*0x5bd1e995u)&(groups.size()-1);
+  }
+
+  bool try_set(std::size_t pos,unsigned char f)
+  {
+    if(auto mask=groups[pos].match_available()){
+      groups[pos].set(unchecked_countr_zero((unsigned int)mask),f);
+      return true;
+    }
+    return false;
+  }
+
+  bool try_reset(std::size_t pos,unsigned char f)
+  {
+    if(auto mask=groups[pos].match(f)){
+      groups[pos].reset(unchecked_countr_zero((unsigned int)mask));
+      return true;
+    }
+    return false;
+  }
+
+  std::uint32_t next_random()
+  {
+    rng^=rng<<13;rng^=rng>>17;rng^=rng<<5;
+    return rng;
+  }
+
+  std::size_t   size_=0;
+  std::size_t   group_size_index;
+  group_vector  groups;
+  victim_type   victim;
+  std::uint32_t rng=0x9e3779b9u;
+};
+
+} // namespace rc
+
+} // namespace fxa_unordered
+
+using fxa_unordered::rc::foa_rc_filter;
+
+#endif
@@ -0,0 +1,265 @@
+/* Proof of concept of closed- and open-addressing
+ * unordered associative containers.
+ *
+ * Copyright 2022 Joaquin M Lopez Munoz.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef FOA_RC_FROZEN_HPP
+#define FOA_RC_FROZEN_HPP
+
+#include <boost/config.hpp>
+#include <boost/container_hash/hash.hpp>
+#include <boost/core/bit.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "fxa_common.hpp"
+#include "foa_unordered_rc.hpp"
+
+namespace fxa_unordered{
+
+namespace rc{
+
+/* Read-only rc table with std::string_view keys served directly from a
+ * memory-mapped file. File layout (native endianness and word size, all
+ * offsets relative to the start of the file, sections 64-byte aligned):
+ *
+ *   header | groups | slots | key blob
+ *
+ * groups are rc control words, as in foa_unordered_rc_map, and slot i of
+ * group pos is slots[pos*N+i], holding the offset and size of the key in
+ * the blob and the mapped value. Nothing is position dependent, so the
+ * file can be mapped anywhere, in any number of processes, and lookup
+ * works on the mapping as is. Hash must produce the same values in the
+ * writing and the reading processes.
+ */
+
+template<
+  typename Value,
+  typename Hash=boost::hash<std::string_view>,
+  typename Group=group15,
+  typename SizePolicy=pow2_size,
+  typename Prober=pow2_prober,
+  typename HashSplitPolicy=shift_hash<0>
+>
+class frozen_rc_map
+{
+  static_assert(
+    std::is_trivially_copyable_v<Value>,
+    "Value must be trivially copyable");
+  static_assert(
+    !is_direct_key_group<Group>::value,
+    "direct_key_group does not support string keys");
+
+  using size_policy=SizePolicy;
+  using prober=Prober;
+  using hash_split_policy=HashSplitPolicy;
+  using group_type=Group;
+  static constexpr auto N=group_type::N;
+
+  struct slot
+  {
+    std::uint32_t key_offset;
+    std::uint32_t key_size;
+    Value         value;
+  };
+
+  static constexpr char          file_magic[8]={'F','X','A','F','R','Z','0','1'};
+  static constexpr std::uint32_t byte_order_mark=0x01020304u;
+  static constexpr std::size_t   section_alignment=64;
+
+  struct header
+  {
+    char          magic[8];
+    std::uint32_t byte_order;
+    std::uint32_t word_size;
+    std::uint32_t group_size;
+    std::uint32_t slot_size;
+    std::uint64_t size;
+    std::uint64_t group_size_index;
+    std::uint64_t num_groups;
+    std::uint64_t groups_offset;
+    std::uint64_t slots_offset;
+    std::uint64_t blob_offset;
+    std::uint64_t blob_size;
+  };
+
+public:
+  using key_type=std::string_view;
+  using mapped_type=Value;
+  using size_type=std::size_t;
+
+  /* Writes the frozen image of m, any map with std::string_view-convertible
+   * keys and Value-convertible mapped values providing size() and
+   * for_each (such as foa_unordered_rc_map), to path.
+   */
+  template<typename Map>
+  static void write(const Map& m,const std::string& path,const Hash& h=Hash())
+  {
+    /* same load as an rc container after growing */
+    auto group_size_index=size_policy::size_index(
+      static_cast<std::size_t>(
+        static_cast<float>(m.size())/(0.875f*N))+1);
+    auto num_groups=size_policy::size(group_size_index);
+
+    std::vector<group_type> groups(num_groups);
+    std::vector<slot>       slots(num_groups*N);
+    std::string             blob;
+
+    std::memset(slots.data(),0,slots.size()*sizeof(slot));
+    m.for_each([&](const auto& x){
+      std::string_view k=x.first;
+      if(blob.size()+k.size()>(std::numeric_limits<std::uint32_t>::max)()){
+        throw std::length_error("frozen_rc_map key blob exceeds 4GB");
+      }
+
+      auto hash=h(k);
+      auto short_hash=hash_split_policy::short_hash(hash);
+      for(prober pb(size_policy::position(
+            hash_split_policy::long_hash(hash),group_size_index));;
+          pb.next(num_groups)){
+        auto pos=pb.get();
+        auto& g=groups[pos];
+        if(auto mask=g.match_available()){
+          auto n=(std::size_t)unchecked_countr_zero((unsigned int)mask);
+          g.set(n,short_hash);
+          slots[pos*N+n]={
+            (std::uint32_t)blob.size(),(std::uint32_t)k.size(),
+            static_cast<Value>(x.second)};
+          break;
+        }
+        else g.mark_overflow(short_hash);
+      }
+      blob.append(k);
+    });
+
+    header hd;
+    std::memset(&hd,0,sizeof(hd));
+    std::memcpy(hd.magic,file_magic,sizeof(file_magic));
+    hd.byte_order=byte_order_mark;
+    hd.word_size=sizeof(std::size_t);
+    hd.group_size=sizeof(group_type);
+    hd.slot_size=sizeof(slot);
+    hd.size=m.size();
+    hd.group_size_index=group_size_index;
+    hd.num_groups=num_groups;
+    hd.groups_offset=align(sizeof(header));
+    hd.slots_offset=align(hd.groups_offset+num_groups*sizeof(group_type));
+    hd.blob_offset=align(hd.slots_offset+slots.size()*sizeof(slot));
+    hd.blob_size=blob.size();
+
+    std::ofstream os(path,std::ios::binary|std::ios::trunc);
+    if(!os)throw std::runtime_error("frozen_rc_map: cannot open "+path);
+    std::uint64_t written=0;
+    auto          put=[&](std::uint64_t offset,const void* p,std::size_t n){
+      static constexpr char zeros[section_alignment]={};
+      os.write(zeros,static_cast<std::streamsize>(offset-written));
+      os.write(static_cast<const char*>(p),static_cast<std::streamsize>(n));
+      written=offset+n;
+    };
+    put(0,&hd,sizeof(hd));
+    put(hd.groups_offset,groups.data(),num_groups*sizeof(group_type));
+    put(hd.slots_offset,slots.data(),slots.size()*sizeof(slot));
+    put(hd.blob_offset,blob.data(),blob.size());
+    if(!os.flush())throw std::runtime_error("frozen_rc_map: cannot write "+path);
+  }
+
+  explicit frozen_rc_map(const std::string& path,const Hash& h=Hash()):
+    h{h},
+    file{path.c_str(),boost::interprocess::read_only},
+    region{file,boost::interprocess::read_only}
+  {
+    auto base=static_cast<const char*>(region.get_address());
+    auto file_size=region.get_size();
+    header hd;
+    if(file_size<sizeof(hd))throw_bad_format();
+    std::memcpy(&hd,base,sizeof(hd));
+    if(std::memcmp(hd.magic,file_magic,sizeof(file_magic))!=0||
+       hd.byte_order!=byte_order_mark||
+       hd.word_size!=sizeof(std::size_t)||
+       hd.group_size!=sizeof(group_type)||
+       hd.slot_size!=sizeof(slot)||
+       hd.num_groups!=size_policy::size(hd.group_size_index)||
+       hd.blob_offset+hd.blob_size>file_size)throw_bad_format();
+
+    size_=hd.size;
+    group_size_index=hd.group_size_index;
+    num_groups=hd.num_groups;
+    groups=reinterpret_cast<const group_type*>(base+hd.groups_offset);
+    slots=reinterpret_cast<const slot*>(base+hd.slots_offset);
+    blob=base+hd.blob_offset;
+  }
+
+  frozen_rc_map(const frozen_rc_map&)=delete;
+  frozen_rc_map& operator=(const frozen_rc_map&)=delete;
+
+  size_type size()const noexcept{return size_;}
+
+  /* nullptr if not found; points into the mapping */
+  BOOST_FORCEINLINE const mapped_type* find(std::string_view k)const
+  {
+    auto   hash=h(k);
+    auto   short_hash=hash_split_policy::short_hash(hash);
+    prober pb(size_policy::position(
+      hash_split_policy::long_hash(hash),group_size_index));
+    do{
+      auto pos=pb.get();
+      auto pg=groups+pos;
+      auto mask=pg->match(short_hash);
+      while(mask){
+        auto  n=unchecked_countr_zero((unsigned int)mask);
+        auto& s=slots[pos*N+n];
+        if(BOOST_LIKELY(
+          std::string_view(blob+s.key_offset,s.key_size)==k)){
+          return &s.value;
+        }
+        mask&=mask-1;
+      }
+      if(BOOST_LIKELY(pg->is_not_overflowed(short_hash)))return nullptr;
+    }
+    while(BOOST_LIKELY(pb.next(num_groups)));
+    return nullptr;
+  }
+
+  bool contains(std::string_view k)const{return find(k)!=nullptr;}
+
+private:
+  static std::uint64_t align(std::uint64_t n)
+  {
+    return (n+section_alignment-1)/section_alignment*section_alignment;
+  }
+
+  [[noreturn]] static void throw_bad_format()
+  {
+    throw std::runtime_error("frozen_rc_map: invalid or incompatible file");
+  }
+
+  Hash                                h;
+  boost::interprocess::file_mapping   file;
+  boost::interprocess::mapped_region  region;
+  std::size_t                         size_=0;
+  std::size_t                         group_size_index=0;
+  std::size_t                         num_groups=0;
+  const group_type                    *groups=nullptr;
+  const slot                          *slots=nullptr;
+  const char                          *blob=nullptr;
+};
+
+} // namespace rc
+
+} // namespace fxa_unordered
+
+using fxa_unordered::rc::frozen_rc_map;
+
+#endif
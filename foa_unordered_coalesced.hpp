@@ -19,6 +19,7 @@
 #include <functional>
 #include <limits>
 #include <memory>
+#include <stdexcept>
 #include <type_traits>
 #include <vector>
 #include "fxa_common.hpp"
@@ -214,6 +215,18 @@ struct coalesced_set_node_array
     }
     --count_;
   }
+
+  // back to the just-constructed state, elements must be destroyed already
+  void clear()
+  {
+    for(auto p=begin(),last=end();p!=last;++p){
+      p->reset();
+      p->set_next(nullptr);
+    }
+    count_=0;
+    top=&v.back();
+    free=nullptr;
+  }
   
 private:
   std::size_t                 address_size_;
@@ -258,10 +271,7 @@ public:
   };
   using iterator=const_iterator;
 
-  ~foa_unordered_coalesced_set()
-  {
-    for(auto& n:nodes)if(n.is_occupied())delete_element(&n);
-  }
+  ~foa_unordered_coalesced_set(){destroy_elements();}
   
   const_iterator begin()const noexcept
   {
@@ -274,6 +284,42 @@ public:
   const_iterator end()const noexcept{return nodes.end();}
   size_type size()const noexcept{return size_;};
 
+  /* address region only, the cellar is not counted */
+  size_type capacity()const noexcept{return nodes.address_size();}
+
+  float load_factor()const noexcept
+  {
+    return static_cast<float>(size_)/static_cast<float>(capacity());
+  }
+
+  float max_load_factor()const noexcept{return mlf;}
+
+  /* capped at 1, overflow beyond the address region goes to the cellar */
+  void max_load_factor(float z)
+  {
+    if(!(z>0.0f)){
+      throw std::invalid_argument(
+        "foa_unordered_coalesced_set: invalid max load factor");
+    }
+    if(z>1.0f)z=1.0f;
+    mlf=z;
+    ml=max_load();
+    if(nodes.count()>ml)rehash(size_);
+  }
+
+  void reserve(size_type n)
+  {
+    if(n>ml)rehash(n);
+  }
+
+  /* keeps capacity, only occupied nodes are destroyed */
+  void clear()noexcept
+  {
+    destroy_elements();
+    nodes.clear();
+    size_=0;
+  }
+
   auto insert(const T& x){return insert_impl(x);}
   auto insert(T&& x){return insert_impl(std::move(x));}
 
@@ -368,6 +414,13 @@ private:
     p->mark_deleted();
   }
 
+  void destroy_elements()
+  {
+    if constexpr(!std::is_trivially_destructible_v<T>){
+      for(auto& n:nodes)if(n.is_occupied())alloc_traits::destroy(al,n.data());
+    }
+  }
+
   template<typename Value>
   std::pair<iterator,bool> insert_impl(Value&& x)
   {
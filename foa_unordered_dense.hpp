@@ -0,0 +1,479 @@
+/* Proof of concept of closed- and open-addressing
+ * unordered associative containers.
+ *
+ * Copyright 2022 Joaquin M Lopez Munoz.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef FOA_UNORDERED_DENSE_HPP
+#define FOA_UNORDERED_DENSE_HPP
+
+#include <boost/config.hpp>
+#include <boost/container_hash/hash.hpp>
+#include <boost/core/bit.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "fxa_common.hpp"
+#include "foa_unordered_rc.hpp"
+
+namespace fxa_unordered{
+
+namespace dense{
+
+/* Iteration follows the element vector: iterators are plain pointers. */
+
+struct storage_order
+{
+  template<typename T,typename Allocator>
+  struct order
+  {
+    using index_type=std::uint32_t;
+    using const_iterator=const T*;
+
+    order(const Allocator&){}
+
+    const_iterator begin(const T* pv)const{return pv;}
+    const_iterator end(const T* pv,std::size_t n)const{return pv+n;}
+    const_iterator at(const T* pv,index_type i)const{return pv+i;}
+    index_type     index(const T* pv,const_iterator it)const
+                     {return static_cast<index_type>(it-pv);}
+
+    /* iterator following i once i is erased and last moved into i */
+    const_iterator next_after_erase(
+      const T* pv,index_type i,index_type /* last */)const{return pv+i;}
+
+    void reserve(std::size_t){}
+    void push_back(index_type){}
+    void pop_back(){}
+    void unlink(index_type){}
+    void move(index_type /* from */,index_type /* to */){}
+    void clear(){}
+  };
+};
+
+/* Iteration follows insertion order through a doubly-linked list of
+ * 32-bit indices threaded over the (still contiguous) element vector.
+ */
+
+struct insertion_order
+{
+  template<typename T,typename Allocator>
+  struct order
+  {
+    using index_type=std::uint32_t;
+    static constexpr index_type nil=(std::numeric_limits<index_type>::max)();
+
+    struct link{index_type prev,next;};
+
+    class const_iterator:public boost::iterator_facade<
+      const_iterator,const T,boost::forward_traversal_tag>
+    {
+    public:
+      const_iterator()=default;
+
+    private:
+      friend struct order;
+      friend class boost::iterator_core_access;
+
+      const_iterator(const T* pv,const link* pl,index_type i):
+        pv{pv},pl{pl},i{i}{}
+
+      const T& dereference()const noexcept{return pv[i];}
+      bool equal(const const_iterator& x)const noexcept{return i==x.i;}
+      void increment()noexcept{i=pl[i].next;}
+
+      const T    *pv=nullptr;
+      const link *pl=nullptr;
+      index_type i=nil;
+    };
+
+    order(const Allocator& al):links{al}{}
+
+    const_iterator begin(const T* pv)const{return {pv,links.data(),head};}
+    const_iterator end(const T*,std::size_t)const{return {};}
+    const_iterator at(const T* pv,index_type i)const
+                     {return {pv,links.data(),i};}
+    index_type     index(const T*,const_iterator it)const{return it.i;}
+
+    const_iterator next_after_erase(
+      const T* pv,index_type i,index_type last)const
+    {
+      auto next=links[i].next;
+      if(next==last)next=i;
+      return {pv,links.data(),next};
+    }
+
+    void reserve(std::size_t n){links.reserve(n);}
+
+    void push_back(index_type i)
+    {
+      links.push_back({tail,nil});
+      (tail!=nil?links[tail].next:head)=i;
+      tail=i;
+    }
+
+    void pop_back(){links.pop_back();}
+
+    void unlink(index_type i)
+    {
+      auto [prev,next]=links[i];
+      (prev!=nil?links[prev].next:head)=next;
+      (next!=nil?links[next].prev:tail)=prev;
+    }
+
+    void move(index_type from,index_type to)
+    {
+      auto [prev,next]=links[to]=links[from];
+      (prev!=nil?links[prev].next:head)=to;
+      (next!=nil?links[next].prev:tail)=to;
+    }
+
+    void clear()
+    {
+      links.clear();
+      head=tail=nil;
+    }
+
+  private:
+    using link_allocator_type=
+      typename std::allocator_traits<Allocator>::template rebind_alloc<link>;
+
+    std::vector<link,link_allocator_type> links;
+    index_type                            head=nil,
+                                          tail=nil;
+  };
+};
+
+/* Elements are kept contiguously in a vector (erasure moves the last
+ * element into the vacated position) and the rc-style group table only
+ * holds, for each slot, the reduced hash in the group control word and a
+ * 32-bit index into the element vector. Rehashing rebuilds the table but
+ * never moves elements around.
+ */
+
+template<
+  typename T,typename Hash=boost::hash<T>,typename Pred=std::equal_to<T>,
+  typename Allocator=std::allocator<T>,
+  typename Group=rc::group15,
+  typename SizePolicy=pow2_size,
+  typename Prober=rc::pow2_prober, // must match growing policy
+  typename HashSplitPolicy=shift_hash<0>,
+  typename OrderPolicy=storage_order
+>
+class foa_unordered_dense_set
+{
+  using size_policy=SizePolicy;
+  using prober=Prober;
+  using hash_split_policy=HashSplitPolicy;
+  using alloc_traits=std::allocator_traits<Allocator>;
+  using group_type=Group;
+  using index_type=std::uint32_t;
+  using group_vector=std::vector<
+    group_type,typename alloc_traits::template rebind_alloc<group_type>>;
+  using index_vector=std::vector<
+    index_type,typename alloc_traits::template rebind_alloc<index_type>>;
+  using value_vector=std::vector<T,Allocator>;
+  using order_type=typename OrderPolicy::template order<T,Allocator>;
+  static constexpr auto N=group_type::N;
+
+public:
+  using key_type=T;
+  using value_type=T;
+  using size_type=std::size_t;
+  using const_iterator=typename order_type::const_iterator;
+  using iterator=const_iterator;
+
+  foa_unordered_dense_set()=default;
+  foa_unordered_dense_set(const foa_unordered_dense_set&)=default;
+  foa_unordered_dense_set(foa_unordered_dense_set&&)=default;
+  foa_unordered_dense_set& operator=(const foa_unordered_dense_set&)=default;
+  foa_unordered_dense_set& operator=(foa_unordered_dense_set&&)=default;
+
+  const_iterator begin()const noexcept{return order.begin(values.data());}
+
+  const_iterator end()const noexcept
+  {
+    return order.end(values.data(),values.size());
+  }
+
+  size_type size()const noexcept{return values.size();};
+
+  /* keeps capacity */
+  void clear()noexcept
+  {
+    values.clear();
+    order.clear();
+    std::fill(groups.begin(),groups.end(),group_type{});
+  }
+
+  auto insert(const T& x){return insert_impl(x);}
+  auto insert(T&& x){return insert_impl(std::move(x));}
+
+  /* the last element is moved into the vacated position: with
+   * storage_order, the iterator returned points to pos again
+   */
+  iterator erase(const_iterator pos)
+  {
+    auto i=order.index(values.data(),pos);
+    auto next=order.next_after_erase(
+      values.data(),i,static_cast<index_type>(values.size()-1));
+    erase_slot(slot_for_index(*pos,i),i);
+    return next;
+  }
+
+  template<typename Key>
+  size_type erase(const Key& x)
+  {
+    auto hash=h(x);
+    auto [slot,i]=find_slot(
+      x,position_for(hash_split_policy::long_hash(hash)),
+      hash_split_policy::short_hash(hash));
+    if(slot==npos)return 0;
+    erase_slot(slot,i);
+    return 1;
+  }
+
+  template<typename Key>
+  BOOST_FORCEINLINE iterator find(const Key& x)const
+  {
+    auto hash=h(x);
+    auto [slot,i]=find_slot(
+      x,position_for(hash_split_policy::long_hash(hash)),
+      hash_split_policy::short_hash(hash));
+    return slot!=npos?order.at(values.data(),i):end();
+  }
+
+  template<typename F>
+  void for_each(F f)const
+  {
+    if constexpr(std::is_same<OrderPolicy,storage_order>::value){
+      for(const auto& x:values)f(x);
+    }
+    else{
+      for(const auto& x:*this)f(x);
+    }
+  }
+
+  void rehash(std::size_t nb)
+  {
+    std::size_t n=static_cast<std::size_t>(1.0f+static_cast<float>(nb)*mlf);
+    if(n>ml)unchecked_reserve(n);
+  }
+
+  void reserve(std::size_t n)
+  {
+    if(n>ml)unchecked_reserve(n);
+  }
+
+  size_type capacity()const noexcept{return groups.size()*N;}
+
+  float load_factor()const noexcept
+  {
+    return static_cast<float>(values.size())/static_cast<float>(capacity());
+  }
+
+  float max_load_factor()const{return mlf;}
+
+  /* capped at 1, max load always leaves one slot available */
+  void max_load_factor(float z)
+  {
+    if(!(z>0.0f)){
+      throw std::invalid_argument(
+        "foa_unordered_dense_set: invalid max load factor");
+    }
+    if(z>1.0f)z=1.0f;
+    mlf=z;
+    ml=max_load(groups.size());
+    if(values.size()>ml)unchecked_reserve(values.size());
+  }
+
+private:
+  static constexpr std::size_t npos=(std::numeric_limits<std::size_t>::max)();
+
+  std::size_t position_for(std::size_t hash)const
+  {
+    return size_policy::position(hash,group_size_index);
+  }
+
+  /* returns {slot,index} or {npos,_} */
+  template<typename Key>
+  BOOST_FORCEINLINE std::pair<std::size_t,index_type> find_slot(
+    const Key& x,std::size_t pos0,std::size_t short_hash)const
+  {
+    prober pb(pos0);
+    do{
+      auto pos=pb.get();
+      auto pg=groups.data()+pos;
+      auto mask=pg->match(short_hash);
+      while(mask){
+        auto slot=pos*N+rc::unchecked_countr_zero((unsigned int)mask);
+        auto i=indices[slot];
+        if(BOOST_LIKELY(pred(x,values[i])))return {slot,i};
+        mask&=mask-1;
+      }
+      if(BOOST_LIKELY(pg->is_not_overflowed(short_hash)))break;
+    }
+    while(BOOST_LIKELY(pb.next(groups.size())));
+    return {npos,0};
+  }
+
+  /* slot pointing to the element at index i, which must exist */
+  std::size_t slot_for_index(const value_type& x,index_type i)const
+  {
+    auto hash=h(x);
+    auto short_hash=hash_split_policy::short_hash(hash);
+    for(prober pb(position_for(hash_split_policy::long_hash(hash)));;
+        pb.next(groups.size())){
+      auto pos=pb.get();
+      auto mask=groups[pos].match(short_hash);
+      while(mask){
+        auto slot=pos*N+rc::unchecked_countr_zero((unsigned int)mask);
+        if(indices[slot]==i)return slot;
+        mask&=mask-1;
+      }
+    }
+  }
+
+  void erase_slot(std::size_t slot,index_type i)
+  {
+    groups[slot/N].reset(slot%N);
+    order.unlink(i);
+    auto last=static_cast<index_type>(values.size()-1);
+    if(i!=last){
+      indices[slot_for_index(values[last],last)]=i;
+      values[i]=std::move(values[last]);
+      order.move(last,i);
+    }
+    values.pop_back();
+    order.pop_back();
+  }
+
+  template<typename Value>
+  BOOST_FORCEINLINE std::pair<iterator,bool> insert_impl(Value&& x)
+  {
+    auto hash=h(x);
+    auto long_hash=hash_split_policy::long_hash(hash);
+    auto pos0=position_for(long_hash);
+    auto short_hash=hash_split_policy::short_hash(hash);
+    auto [slot,i]=find_slot(rc::extract_key(x),pos0,short_hash);
+
+    if(slot!=npos){
+      return {order.at(values.data(),i),false};
+    }
+    else if(BOOST_UNLIKELY(values.size()>=ml)){
+      unchecked_reserve(values.size()+1);
+      pos0=position_for(long_hash);
+    }
+    if(BOOST_UNLIKELY(
+      values.size()>=(std::numeric_limits<index_type>::max)())){
+      throw std::length_error("foa_unordered_dense_set: too many elements");
+    }
+    values.push_back(std::forward<Value>(x));
+    i=static_cast<index_type>(values.size()-1);
+    try{
+      order.push_back(i);
+    }
+    catch(...){
+      values.pop_back();
+      throw;
+    }
+    unchecked_insert(i,pos0,short_hash);
+    return {order.at(values.data(),i),true};
+  }
+
+  void unchecked_insert(index_type i,std::size_t pos0,std::size_t short_hash)
+  {
+    for(prober pb(pos0);;pb.next(groups.size())){
+      auto pos=pb.get();
+      auto pg=groups.data()+pos;
+      auto mask=pg->match_available();
+      if(BOOST_LIKELY(mask)){
+        auto n=rc::unchecked_countr_zero((unsigned int)mask);
+        pg->set(n,short_hash);
+        indices[pos*N+n]=i;
+        return;
+      }
+      else pg->mark_overflow(short_hash);
+    }
+  }
+
+  /* only the table is rebuilt, elements stay where they are */
+  BOOST_NOINLINE void unchecked_reserve(size_type new_size)
+  {
+    std::size_t nc =(std::numeric_limits<std::size_t>::max)();
+    float       fnc=1.0f+static_cast<float>(new_size)/mlf;
+    if(nc>fnc)nc=static_cast<std::size_t>(fnc);
+
+    auto         new_group_size_index=size_policy::size_index(nc/N+1);
+    group_vector new_groups(size_policy::size(new_group_size_index),al);
+    index_vector new_indices(new_groups.size()*N,al);
+    values.reserve(max_load(new_groups.size()));
+    order.reserve(max_load(new_groups.size()));
+
+    groups.swap(new_groups);
+    indices.swap(new_indices);
+    group_size_index=new_group_size_index;
+    ml=max_load(groups.size());
+
+    for(std::size_t i=0,last=values.size();i!=last;++i){
+      auto hash=h(values[i]);
+      unchecked_insert(
+        static_cast<index_type>(i),
+        position_for(hash_split_policy::long_hash(hash)),
+        hash_split_policy::short_hash(hash));
+    }
+  }
+
+  size_type max_load(std::size_t num_groups)const
+  {
+    float fml=mlf*static_cast<float>(num_groups*N-1);
+    auto res=(std::numeric_limits<size_type>::max)();
+    if(res>fml)res=static_cast<size_type>(fml);
+    return res;
+  }
+
+  Hash                                     h;
+  Pred                                     pred;
+  Allocator                                al;
+  float                                    mlf=0.875;
+  std::size_t                              group_size_index=size_policy::size_index(1);
+  group_vector                             groups{size_policy::size(group_size_index),al};
+  index_vector                             indices{groups.size()*N,al};
+  value_vector                             values{al};
+  order_type                               order{al};
+  size_type                                ml=max_load(groups.size());
+};
+
+template<
+  typename Key,typename Value,
+  typename Hash=boost::hash<Key>,typename Pred=std::equal_to<Key>,
+  typename Allocator=std::allocator<map_value_adaptor<Key,Value>>,
+  typename Group=rc::group15,
+  typename SizePolicy=pow2_size,
+  typename Prober=rc::pow2_prober,
+  typename HashSplitPolicy=shift_hash<0>,
+  typename OrderPolicy=storage_order
+>
+using foa_unordered_dense_map=foa_unordered_dense_set<
+  map_value_adaptor<Key,Value>,
+  map_hash_adaptor<Hash>,map_pred_adaptor<Pred>,
+  Allocator,Group,SizePolicy,Prober,HashSplitPolicy,OrderPolicy
+>;
+
+} // namespace dense
+
+} // namespace fxa_unordered
+
+using fxa_unordered::dense::foa_unordered_dense_set;
+using fxa_unordered::dense::foa_unordered_dense_map;
+
+#endif
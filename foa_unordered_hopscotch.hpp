@@ -14,6 +14,7 @@
 #include <boost/container_hash/hash.hpp>
 #include <boost/core/bit.hpp>
 #include <boost/iterator/iterator_facade.hpp>
+#include <algorithm>
 #include <cassert>
 #include <climits>
 #include <cstdint>
@@ -61,6 +62,8 @@ public:
 
   bucket operator[](std::size_t n){return {v[n/2],n%2};}
 
+  void clear(){std::fill(v.begin(),v.end(),0xFFu);}
+
 private:
   std::vector<
     unsigned char,
@@ -149,9 +152,7 @@ public:
 
   ~foa_unordered_hopscotch_set()
   {
-    if(!elements.empty()){
-      for(auto first=begin(),last=end();first!=last;)erase(first++);
-    }
+    if(!elements.empty())destroy_elements();
   }
   
   const_iterator begin()const noexcept
@@ -173,6 +174,43 @@ public:
 
   size_type size()const noexcept{return size_;};
 
+  size_type capacity()const noexcept{return capacity_;}
+
+  float load_factor()const noexcept
+  {
+    return static_cast<float>(size_)/static_cast<float>(capacity());
+  }
+
+  float max_load_factor()const noexcept{return mlf;}
+
+  /* capped at 1, max load always leaves one slot available */
+  void max_load_factor(float z)
+  {
+    if(!(z>0.0f)){
+      throw std::invalid_argument(
+        "foa_unordered_hopscotch_set: invalid max load factor");
+    }
+    if(z>1.0f)z=1.0f;
+    mlf=z;
+    ml=max_load();
+    if(size_>ml)rehash(size_);
+  }
+
+  void reserve(size_type n)
+  {
+    if(n>ml)rehash(n);
+  }
+
+  /* keeps capacity, sentinel control is left untouched */
+  void clear()noexcept
+  {
+    if(elements.empty())return;
+    destroy_elements();
+    std::fill(controls.begin(),controls.begin()+capacity_,control{});
+    buckets.clear();
+    size_=0;
+  }
+
   auto insert(const T& x){return insert_impl(x);}
   auto insert(T&& x){return insert_impl(std::move(x));}
 
@@ -249,8 +287,8 @@ private:
   };
 
   // used only on rehash
-  foa_unordered_hopscotch_set(std::size_t n,Allocator al):
-    al{al},size_index{size_policy::size_index(n)}
+  foa_unordered_hopscotch_set(std::size_t n,float mlf,Allocator al):
+    al{al},mlf{mlf},size_index{size_policy::size_index(n)}
   {
     controls.back().set(0);
   }
@@ -266,6 +304,15 @@ private:
     alloc_traits::destroy(al,p);
   }
 
+  void destroy_elements()
+  {
+    if constexpr(!std::is_trivially_destructible_v<T>){
+      for(std::size_t pos=0;pos<capacity_;++pos){
+        if(controls[pos].occupied())destroy_element(elements[pos].data());
+      }
+    }
+  }
+
   std::size_t position_for(std::size_t hash)const
   {
     return size_policy::position(boost::core::rotl(hash,4),size_index);
@@ -294,7 +341,10 @@ private:
     if(BOOST_UNLIKELY(
       size_+1>ml||
       (it=unchecked_insert(std::forward<Value>(x),pos,hash))==end())){
-      rehash(ml+1);
+      /* size for the next capacity up: with mlf close to 1, ml+1 would fit
+       * right back into the current one
+       */
+      rehash(static_cast<size_type>(static_cast<float>(capacity_)*mlf)+1);
       pos=position_for(hash);
       it=unchecked_insert(std::forward<Value>(x),pos,hash);
       if(it==end())throw hopscotch_failure();
@@ -309,7 +359,7 @@ private:
     float       fnc=1.0f+static_cast<float>(new_size)/mlf;
     if(nc>fnc)nc=static_cast<std::size_t>(fnc);
 
-    foa_unordered_hopscotch_set new_container{nc,al};
+    foa_unordered_hopscotch_set new_container{nc,mlf,al};
     std::size_t                 num_tx=0;
     try{
       for(std::size_t pos=0;pos<capacity_;++pos){
@@ -434,7 +484,7 @@ private:
 
   size_type max_load()const
   {
-    float fml=mlf*static_cast<float>(capacity_);
+    float fml=mlf*static_cast<float>(capacity_-1);
     auto res=(std::numeric_limits<size_type>::max)();
     if(res>fml)res=static_cast<size_type>(fml);
     return res;
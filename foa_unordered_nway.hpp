@@ -13,7 +13,9 @@
 #include <boost/config.hpp>
 #include <boost/container_hash/hash.hpp>
 #include <boost/core/bit.hpp>
+#include <boost/iterator/counting_iterator.hpp>
 #include <boost/iterator/iterator_facade.hpp>
+#include <algorithm>
 #include <cassert>
 #include <climits>
 #include <cmath>
@@ -21,6 +23,7 @@
 #include <functional>
 #include <limits>
 #include <memory>
+#include <stdexcept>
 #include <tuple>
 #include <type_traits>
 #include <vector>
@@ -233,6 +236,31 @@ public:
   const_iterator end()const noexcept{return groups.end();}
   size_type size()const noexcept{return size_;};
 
+  size_type capacity()const noexcept{return size_policy::size(size_index);}
+
+  float load_factor()const noexcept
+  {
+    return static_cast<float>(size_)/static_cast<float>(capacity());
+  }
+
+  float max_load_factor()const noexcept{return mlf;}
+
+  void max_load_factor(float z)
+  {
+    if(!(z>0.0f)){
+      throw std::invalid_argument(
+        "foa_unordered_nway_set: invalid max load factor");
+    }
+    mlf=z;
+    ml=max_load();
+    if(size_>ml)rehash(size_);
+  }
+
+  void reserve(size_type n)
+  {
+    if(n>ml)rehash(n);
+  }
+
   auto insert(const T& x){return insert_impl(x);}
   auto insert(T&& x){return insert_impl(std::move(x));}
 
@@ -769,6 +797,8 @@ template<typename T,typename GroupBase>
 struct soa_group:GroupBase
 {
   using element_type=element<T>;
+
+  void clear(){static_cast<GroupBase&>(*this)=GroupBase{};}
 };
 
 template<typename T,typename GroupBase>
@@ -786,6 +816,12 @@ struct soa_coalesced_group:soa_group<T,GroupBase>
 {
   soa_coalesced_group*& next(){return next_;}
 
+  void clear()
+  {
+    soa_group<T,GroupBase>::clear();
+    next_=nullptr;
+  }
+
 private:
   soa_coalesced_group *next_=nullptr;
 };
@@ -795,6 +831,12 @@ struct coalesced_group:regular_group<T,GroupBase>
 {
   coalesced_group*& next(){return next_;}
 
+  void clear()
+  {
+    regular_group<T,GroupBase>::clear();
+    next_=nullptr;
+  }
+
 private:
   coalesced_group *next_=nullptr;
 };
@@ -1052,6 +1094,15 @@ public:
   // only in moved-from state when rehashing
   bool empty()const{return !this->size();}
 
+  // back to the just-constructed state, elements must be destroyed already
+  void clear()
+  {
+    for(auto it=this->begin(),last=this->end();it!=last;++it){
+      control(it).clear();
+    }
+    control(this->end()-1).set_sentinel();
+  }
+
   std::pair<iterator,int> new_group_after(iterator first,iterator /*it*/)
   {
     for(auto pr=make_prober(first);;){
@@ -1124,6 +1175,15 @@ public:
   // only in moved-from state when rehashing
   bool empty()const{return !this->size();}
 
+  // back to the just-constructed state, elements must be destroyed already
+  void clear()
+  {
+    for(auto it=this->begin(),last=this->end();it!=last;++it){
+      control(it).clear();
+    }
+    control(this->end()-1).set_sentinel();
+  }
+
   std::pair<iterator,int> new_group_after(iterator first,iterator /*it*/)
   {
     for(auto pr=make_prober(first);;){
@@ -1245,6 +1305,12 @@ public:
 
   using GroupArray::control;
 
+  void clear()
+  {
+    super::clear();
+    top=this->end()-1;
+  }
+
   std::pair<iterator,int> new_group_after(iterator first,iterator it)
   {
     assert(!control(it).match_empty_or_deleted());
@@ -1528,9 +1594,7 @@ public:
 
   ~foa_unordered_nwayplus_set()
   {
-    if(!groups.empty()){
-     for(auto first=begin(),last=end();first!=last;)erase(first++);
-    }
+    if(!groups.empty())destroy_elements();
   }
   
   const_iterator begin()const noexcept
@@ -1544,6 +1608,42 @@ public:
   const_iterator end()const noexcept{return {groups.end()-1,N-1};}
   size_type size()const noexcept{return size_;};
 
+  size_type capacity()const noexcept{return size_policy::size(group_size_index)*N;}
+
+  float load_factor()const noexcept
+  {
+    return static_cast<float>(size_)/static_cast<float>(capacity());
+  }
+
+  float max_load_factor()const noexcept{return mlf;}
+
+  /* capped at 1, max load always leaves one slot available */
+  void max_load_factor(float z)
+  {
+    if(!(z>0.0f)){
+      throw std::invalid_argument(
+        "foa_unordered_nwayplus_set: invalid max load factor");
+    }
+    if(z>1.0f)z=1.0f;
+    mlf=z;
+    ml=max_load();
+    if(size_>ml)rehash(size_);
+  }
+
+  void reserve(size_type n)
+  {
+    if(n>ml)rehash(n);
+  }
+
+  /* keeps capacity, only occupied slots are destroyed */
+  void clear()noexcept
+  {
+    if(groups.empty())return;
+    destroy_elements();
+    groups.clear();
+    size_=0;
+  }
+
   auto insert(const T& x){return insert_impl(x);}
   auto insert(T&& x){return insert_impl(std::move(x));}
 
@@ -1572,6 +1672,54 @@ public:
     return find_impl(x,linked_groups());
   }
 
+  /* maps only: if an element with key k exists, update is invoked on its
+   * mapped value, otherwise {k,init} is inserted; returns true if insertion
+   * took place
+   */
+  template<typename Key,typename Init,typename Update>
+  bool upsert(const Key& k,Init&& init,Update update)
+  {
+    auto [it,inserted]=emplace_impl(
+      k,[&]{return value_type(k,std::forward<Init>(init));});
+    if(!inserted)update(it->second);
+    return inserted;
+  }
+
+  /* maps only */
+  template<typename Key,typename Delta>
+  bool add(const Key& k,const Delta& delta)
+  {
+    return upsert(k,delta,[&](auto& v){v+=delta;});
+  }
+
+  template<typename F>
+  void for_each(F f)const
+  {
+    for_each_in_groups(0,groups.size(),f);
+  }
+
+#if defined(FXA_UNORDERED_PARALLEL_ALGORITHMS)
+  /* f can be invoked concurrently from several threads */
+  template<
+    typename ExecutionPolicy,typename F,
+    typename=enable_if_execution_policy_t<ExecutionPolicy>
+  >
+  void for_each(ExecutionPolicy&& policy,F f)const
+  {
+    auto num_groups=groups.size(),
+         num_chunks=(num_groups+for_each_chunk_size-1)/for_each_chunk_size;
+    std::for_each(
+      std::forward<ExecutionPolicy>(policy),
+      boost::counting_iterator<std::size_t>(0),
+      boost::counting_iterator<std::size_t>(num_chunks),
+      [&,this](std::size_t chunk){
+        auto first=chunk*for_each_chunk_size,
+             last=(std::min)(first+for_each_chunk_size,num_groups);
+        for_each_in_groups(first,last,f);
+      });
+  }
+#endif
+
 #ifdef FOA_UNORDERED_NWAYPLUS_STATUS
   void status()
   {
@@ -1600,6 +1748,21 @@ private:
     alloc_traits::destroy(al,p);
   }
 
+  void destroy_elements()
+  {
+    if constexpr(!std::is_trivially_destructible_v<T>){
+      for(auto itg=groups.begin(),last=groups.end();itg!=last;++itg){
+        auto mask=control(itg).match_really_occupied();
+        while(mask){
+          FXA_ASSUME(mask!=0);
+          auto n=std::size_t(boost::core::countr_zero((unsigned int)mask));
+          destroy_element(elements(itg).at(n).data());
+          mask&=mask-1;
+        }
+      }
+    }
+  }
+
   static void prefetch(const void* p)
   {
 #if defined(BOOST_GCC)||defined(BOOST_CLANG)
@@ -1630,6 +1793,22 @@ private:
     return groups.at(size_policy::position(hash,group_size_index));
   }
 
+  template<typename F>
+  void for_each_in_groups(std::size_t first,std::size_t last,F& f)const
+  {
+    for(auto itg=groups.begin()+first,itlast=groups.begin()+last;
+        itg!=itlast;++itg){
+      auto mask=control(itg).match_really_occupied();
+      while(mask){
+        FXA_ASSUME(mask!=0);
+        auto n=boost::core::countr_zero((unsigned int)mask);
+        const value_type& x=elements(itg).at(n).value();
+        f(x);
+        mask&=mask-1;
+      }
+    }
+  }
+
   template<typename Key>
   std::pair<int,bool> find_in_group(
     const Key& x,group_iterator itg,unsigned char short_hash)const
@@ -1757,6 +1936,14 @@ private:
 
   template<typename Value>
   std::pair<iterator,bool> insert_impl(Value&& x)
+  {
+    return emplace_impl(
+      x,[&]()->Value&&{return std::forward<Value>(x);});
+  }
+
+  /* make() is only invoked if no element equivalent to x is found */
+  template<typename Key,typename Make>
+  std::pair<iterator,bool> emplace_impl(const Key& x,Make make)
   {
     if constexpr(linked_groups::value){
       auto hash=h(x);
@@ -1768,7 +1955,7 @@ private:
 
       if(BOOST_UNLIKELY(size_+1>ml)){
         rehash(size_+1);
-        return {unchecked_insert(std::forward<Value>(x),long_hash,short_hash),true};
+        return {unchecked_insert(make(),long_hash,short_hash),true};
       }
 
       auto& [itga,na]=ita;
@@ -1776,7 +1963,7 @@ private:
         assert(last);
         std::tie(itga,na)=groups.new_group_after(first,last);
       }
-      construct_element(std::forward<Value>(x),elements(itga).at(na).data());  
+      construct_element(make(),elements(itga).at(na).data());  
       control(itga).set(na,short_hash);
       ++size_;
       return {ita,true};
@@ -1802,7 +1989,7 @@ private:
 
       if(BOOST_UNLIKELY(size_+1>ml)){
         rehash(size_+1);
-        return {unchecked_insert(std::forward<Value>(x),long_hash,short_hash),true};
+        return {unchecked_insert(make(),long_hash,short_hash),true};
       }
 
       pos=pos0;
@@ -1814,7 +2001,7 @@ private:
           FXA_ASSUME(mask!=0);
           int n=boost::core::countr_zero((unsigned int)mask); 
           construct_element(
-            std::forward<Value>(x),elements(itg).at(n).data());  
+            make(),elements(itg).at(n).data());  
           control(itg).set(n,short_hash);
           ++size_;
           return {{itg,n},true};    
@@ -13,8 +13,10 @@
 #include <boost/config.hpp>
 #include <boost/container_hash/hash.hpp>
 #include <boost/core/bit.hpp>
+#include <boost/iterator/counting_iterator.hpp>
 #include <boost/iterator/iterator_facade.hpp>
 #include <boost/predef.h>
+#include <algorithm>
 #include <cassert>
 #include <climits>
 #include <cmath>
@@ -22,6 +24,7 @@
 #include <functional>
 #include <limits>
 #include <memory>
+#include <stdexcept>
 #include <tuple>
 #include <type_traits>
 #include <vector>
@@ -31,6 +34,10 @@
 #include <arm_neon.h>
 #endif
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 namespace fxa_unordered{
 
 namespace rc{
@@ -483,6 +490,12 @@ struct group15
     *pc=0u;
   }
 
+  inline unsigned char stored_hash(std::size_t pos)const // as set
+  {
+    assert(pos<N);
+    return reinterpret_cast<const unsigned char*>(&mask)[pos];
+  }
+
   inline int match(std::size_t hash)const
   {
     auto m=_mm_set1_epi32((int)match_table[(unsigned char)hash]);
@@ -569,6 +582,12 @@ struct group15
     *pc=0u;
   }
 
+  inline unsigned char stored_hash(std::size_t pos)const // as set
+  {
+    assert(pos<N);
+    return reinterpret_cast<const unsigned char*>(&mask)[pos];
+  }
+
   inline int match(std::size_t hash)const
   {
     auto m=vdupq_n_s8(adjust_hash(hash));
@@ -673,6 +692,12 @@ struct group15
     set_impl(pos,0);
   }
 
+  inline unsigned char stored_hash(std::size_t pos)const // as set
+  {
+    return (unsigned char)(
+      uint64_ops::get(mask[0],pos)|(uint64_ops::get(mask[1],pos)<<4));
+  }
+
   static void reset(unsigned char* pc)
   {
     std::size_t pos=reinterpret_cast<uintptr_t>(pc)%sizeof(group15);
@@ -739,6 +764,175 @@ protected:
 
 #endif /* FXA_UNORDERED_SSE2 */
 
+/* For 32/64-bit integral keys: the group stores the keys themselves and
+ * lookup compares them all at once, so there are no reduced-hash false
+ * positives and elements are only accessed on a hit. Each group spans
+ * exactly one cache line: N keys plus a metadata word with occupancy
+ * bits (0 to N-1), the sentinel bit (N) and overflow bits (N+1 to N+8).
+ * Keys are compared with ==, the container's Pred (required to be
+ * std::equal_to) is not used.
+ */
+template<typename Key>
+struct alignas(64) direct_key_group
+{
+  static_assert(
+    std::is_integral<Key>::value&&(sizeof(Key)==4||sizeof(Key)==8),
+    "direct_key_group requires 32-bit or 64-bit integral keys");
+
+  static constexpr int N=64/sizeof(Key)-1;
+
+  inline void set(std::size_t pos,std::size_t /* hash */)
+  {
+    assert(pos<N);
+    metadata|=word_type(1)<<pos;
+  }
+
+  inline void set_key(std::size_t pos,Key x)
+  {
+    keys[pos]=static_cast<word_type>(x);
+  }
+
+  inline void set_sentinel()
+  {
+    metadata|=word_type(1)<<N;
+  }
+
+  inline bool is_sentinel(std::size_t pos)const
+  {
+    return pos==N-1&&(metadata&(word_type(1)<<N));
+  }
+
+  inline void reset(std::size_t pos)
+  {
+    assert(pos<N);
+    metadata&=~(word_type(1)<<pos);
+  }
+
+  static void reset(unsigned char* pc)
+  {
+    auto pg=reinterpret_cast<direct_key_group*>(
+      reinterpret_cast<uintptr_t>(pc)/sizeof(direct_key_group)*
+      sizeof(direct_key_group));
+    pg->reset(static_cast<std::size_t>(
+      pc-reinterpret_cast<unsigned char*>(pg)));
+  }
+
+  /* every occupied slot is a candidate */
+  inline int match(std::size_t /* hash */)const
+  {
+    return match_really_occupied();
+  }
+
+  inline int match_key(Key x)const
+  {
+    return match_key_impl(static_cast<word_type>(x))&match_really_occupied();
+  }
+
+  inline bool is_not_overflowed(std::size_t hash)const
+  {
+    return !(metadata&(word_type(1)<<(N+1+hash%8)));
+  }
+
+  inline void mark_overflow(std::size_t hash)
+  {
+    metadata|=word_type(1)<<(N+1+hash%8);
+  }
+
+  inline int match_available()const
+  {
+    return (~match_occupied())&full_mask;
+  }
+
+  inline int match_occupied()const
+  {
+    return match_really_occupied()|
+      (int)((metadata>>N)&1u)<<(N-1);
+  }
+
+  inline int match_really_occupied()const // excluding sentinel
+  {
+    return (int)(metadata&full_mask);
+  }
+
+private:
+  using word_type=std::make_unsigned_t<Key>;
+
+  static constexpr int full_mask=(1<<N)-1;
+
+#if defined(FXA_UNORDERED_SSE2)
+  inline int match_key_impl(word_type x)const
+  {
+    auto p=reinterpret_cast<const __m128i*>(keys);
+    if constexpr(sizeof(Key)==4){
+      auto k=_mm_set1_epi32((int)x);
+      return _mm_movemask_epi8(_mm_packs_epi16(
+        _mm_packs_epi32(
+          _mm_cmpeq_epi32(_mm_load_si128(p),k),
+          _mm_cmpeq_epi32(_mm_load_si128(p+1),k)),
+        _mm_packs_epi32(
+          _mm_cmpeq_epi32(_mm_load_si128(p+2),k),
+          _mm_cmpeq_epi32(_mm_load_si128(p+3),k))));
+    }
+#if defined(__AVX2__)
+    else{
+      auto q=reinterpret_cast<const __m256i*>(keys);
+      auto k=_mm256_set1_epi64x((long long)x);
+      return
+        _mm256_movemask_pd(_mm256_castsi256_pd(
+          _mm256_cmpeq_epi64(_mm256_load_si256(q),k)))|
+        _mm256_movemask_pd(_mm256_castsi256_pd(
+          _mm256_cmpeq_epi64(_mm256_load_si256(q+1),k)))<<4;
+    }
+#else
+    else{
+      /* no 64-bit compare in SSE2: key i matches if both its 32-bit halves
+       * do, i.e. bits 2i and 2i+1 of the packed mask are set
+       */
+      auto k=_mm_set1_epi64x((long long)x);
+      auto m=(unsigned int)_mm_movemask_epi8(_mm_packs_epi16(
+        _mm_packs_epi32(
+          _mm_cmpeq_epi32(_mm_load_si128(p),k),
+          _mm_cmpeq_epi32(_mm_load_si128(p+1),k)),
+        _mm_packs_epi32(
+          _mm_cmpeq_epi32(_mm_load_si128(p+2),k),
+          _mm_cmpeq_epi32(_mm_load_si128(p+3),k))));
+      m&=(m>>1)&0x5555u;
+      m=(m|(m>>1))&0x3333u;
+      m=(m|(m>>2))&0x0F0Fu;
+      m=(m|(m>>4))&0x00FFu;
+      return (int)m;
+    }
+#endif
+  }
+#else
+  inline int match_key_impl(word_type x)const
+  {
+    int res=0;
+    for(int i=0;i<N;++i)res|=(int)(keys[i]==x)<<i;
+    return res;
+  }
+#endif
+
+  word_type keys[N];
+  word_type metadata=0;
+};
+
+template<typename Group>
+struct is_direct_key_group:std::false_type{};
+
+template<typename Key>
+struct is_direct_key_group<direct_key_group<Key>>:std::true_type{};
+
+/* direct_key_group ignores Pred, which therefore must amount to == */
+template<typename Pred>
+struct is_std_equal_to:std::false_type{};
+
+template<typename T>
+struct is_std_equal_to<std::equal_to<T>>:std::true_type{};
+
+template<typename Pred>
+struct is_std_equal_to<map_pred_adaptor<Pred>>:is_std_equal_to<Pred>{};
+
 template<typename T>
 struct element
 {
@@ -802,6 +996,104 @@ inline int unchecked_countr_zero(unsigned int x)
 #endif
 }
 
+struct plain_iteration
+{
+  template<typename Group,typename Allocator>
+  struct summary
+  {
+    struct cursor
+    {
+      static std::size_t skip(const unsigned char* /* pc */){return 1;}
+    };
+
+    summary(std::size_t /* num_groups */,const Allocator&){}
+
+    cursor      get_cursor(const Group*)const{return {};}
+    std::size_t first()const{return 0;}
+    void        set(std::size_t /* pos */){}
+    void        update(const Group*,std::size_t /* pos */){}
+    void        clear(std::size_t /* num_groups */){}
+  };
+};
+
+struct summary_iteration
+{
+  template<typename Group,typename Allocator>
+  struct summary
+  {
+    static constexpr std::size_t word_width=sizeof(std::size_t)*CHAR_BIT;
+
+    struct cursor
+    {
+      std::size_t skip(const unsigned char* pc)const
+      {
+        auto pos=static_cast<std::size_t>(pc-pc0)/sizeof(Group);
+        return next(bits,pos)-pos;
+      }
+
+      const std::size_t   *bits=nullptr;
+      const unsigned char *pc0=nullptr;
+    };
+
+    summary(std::size_t num_groups,const Allocator& al):
+      bits((num_groups+word_width-1)/word_width,0,al)
+    {
+      /* last group holds the sentinel and is never marked as empty */
+      if(num_groups)set(num_groups-1);
+    }
+
+    cursor get_cursor(const Group* pg)const
+    {
+      return {bits.data(),reinterpret_cast<const unsigned char*>(pg)};
+    }
+
+    std::size_t first()const{return first_;}
+
+    void set(std::size_t pos)
+    {
+      bits[pos/word_width]|=set_bit(pos%word_width);
+      if(pos<first_)first_=pos;
+    }
+
+    void update(const Group* pg,std::size_t pos)
+    {
+      if(!pg->match_occupied()){
+        bits[pos/word_width]&=reset_bit(pos%word_width);
+        if(pos==first_)first_=next(bits.data(),pos);
+      }
+    }
+
+    void clear(std::size_t num_groups)
+    {
+      std::fill(bits.begin(),bits.end(),std::size_t(0));
+      first_=(std::numeric_limits<std::size_t>::max)();
+      if(num_groups)set(num_groups-1);
+    }
+
+  private:
+    /* precondition: some bit beyond pos is set */
+    static std::size_t next(const std::size_t* bits,std::size_t pos)
+    {
+      ++pos;
+      auto w=pos/word_width;
+      auto m=bits[w]&((~std::size_t(0))<<(pos%word_width));
+      while(!m)m=bits[++w];
+      return w*word_width+(std::size_t)boost::core::countr_zero(m);
+    }
+
+    std::vector<std::size_t,Allocator> bits;
+    std::size_t                        first_=(std::numeric_limits<std::size_t>::max)();
+  };
+};
+
+/* unique_keys: at most one element per key.
+ * equivalent_keys: multiset/multimap semantics. Equivalent elements share
+ * hash and hence probe sequence, so they're clustered along it and
+ * retrieved group by group with a single match per group.
+ */
+struct unique_keys{};
+struct equivalent_keys{};
+
 template<typename T>
 inline const T& extract_key(const T& x){return x;}
 
@@ -814,12 +1106,30 @@ void clean_without_destruction(std::vector<T,Allocator>& x)
 {
   using vector_type=std::vector<T,Allocator>;
   using alloc_traits=std::allocator_traits<Allocator>;
+  using pointer_traits=
+    std::pointer_traits<typename alloc_traits::pointer>;
   
   std::aligned_storage_t<sizeof(vector_type),alignof(vector_type)> storage;
   auto pv=::new (reinterpret_cast<vector_type*>(&storage))
     vector_type(std::move(x));
   auto a=pv->get_allocator();
-  alloc_traits::deallocate(a,pv->data(),pv->capacity());
+  if(pv->capacity()){
+    alloc_traits::deallocate(
+      a,pointer_traits::pointer_to(*pv->data()),pv->capacity());
+  }
+}
+
+/* swaps contents along with allocators (move construction always takes
+ * the allocator of its source), whatever propagate_on_container_swap says
+ */
+template<typename T>
+void swap_with_allocators(T& x,T& y)noexcept
+{
+  T tmp(std::move(x));
+  x.~T();
+  ::new (&x) T(std::move(y));
+  y.~T();
+  ::new (&y) T(std::move(tmp));
 }
 
 template<
@@ -828,7 +1138,9 @@ template<
   typename Group=group15,
   typename SizePolicy=pow2_size,
   typename Prober=pow2_prober, // must match growing policy
-  typename HashSplitPolicy=shift_hash<0>
+  typename HashSplitPolicy=shift_hash<0>,
+  typename IterationPolicy=plain_iteration,
+  typename KeyPolicy=unique_keys
 >
 class foa_unordered_rc_set 
 {
@@ -838,14 +1150,28 @@ class foa_unordered_rc_set
   using alloc_traits=std::allocator_traits<Allocator>;
   using group_type=Group;
   using element_type=element<T>;
+  using group_vector=std::vector<
+    group_type,typename alloc_traits::template rebind_alloc<group_type>>;
+  using element_vector=std::vector<
+    element_type,typename alloc_traits::template rebind_alloc<element_type>>;
+  using summary_type=typename IterationPolicy::template summary<
+    group_type,typename alloc_traits::template rebind_alloc<std::size_t>>;
+  using cursor_type=typename summary_type::cursor;
   static constexpr auto N=group_type::N;
+  static constexpr bool multi=std::is_same_v<KeyPolicy,equivalent_keys>;
+
+  static_assert(
+    !is_direct_key_group<group_type>::value||is_std_equal_to<Pred>::value,
+    "direct_key_group compares keys with ==, Pred must be std::equal_to");
 
 public:
   using key_type=T;
   using value_type=T;
   using size_type=std::size_t;
+  using allocator_type=Allocator;
   class const_iterator:public boost::iterator_facade<
-    const_iterator,const value_type,boost::forward_traversal_tag>
+    const_iterator,const value_type,boost::forward_traversal_tag>,
+    private cursor_type
   {
   public:
     const_iterator()=default;
@@ -854,7 +1180,10 @@ public:
     friend class foa_unordered_rc_set;
     friend class boost::iterator_core_access;
 
-    const_iterator(const group_type* pg,std::size_t n,const element_type* pe):
+    const_iterator(
+      const group_type* pg,std::size_t n,const element_type* pe,
+      cursor_type cr):
+      cursor_type{cr},
       pc{reinterpret_cast<unsigned char*>(const_cast<group_type*>(pg))+n},
       pe{const_cast<element_type*>(pe)}
     {
@@ -898,8 +1227,9 @@ public:
       auto mask=(reinterpret_cast<group_type*>(pc)->match_occupied()>>(n0+1))<<(n0+1);
       if(!mask){
         do{
-          pc+=sizeof(group_type);
-          pe+=N;
+          auto d=this->skip(pc);
+          pc+=d*sizeof(group_type);
+          pe+=d*N;
         }
         while(!(mask=reinterpret_cast<group_type*>(pc)->match_occupied()));
       }
@@ -919,6 +1249,111 @@ public:
   };
   using iterator=const_iterator;
 
+  /* walks the elements equivalent to a given key along its probe sequence;
+   * the key of the element pointed to is used in place of the one passed,
+   * which need not outlive the iterator, so that, as usual, only erasing
+   * that element invalidates it
+   */
+  template<typename Key>
+  class equal_iterator:public boost::iterator_facade<
+    equal_iterator<Key>,const value_type,boost::forward_traversal_tag>
+  {
+  public:
+    equal_iterator()=default;
+
+    iterator base()const
+    {
+      if(!pg)return {};
+      return {pg,n,c->elements.data()+pos*N+n,c->cursor()};
+    }
+
+  private:
+    friend class foa_unordered_rc_set;
+    friend class boost::iterator_core_access;
+
+    using element_key_type=std::remove_cv_t<std::remove_reference_t<
+      decltype(extract_key(std::declval<const value_type&>()))>>;
+
+    equal_iterator(
+      const foa_unordered_rc_set* c,const Key& x,
+      std::size_t pos0,std::size_t short_hash):
+      c{c},short_hash{short_hash},pb{pos0},pos{pos0},
+      pg{c->groups.data()+pos0},mask{c->match(pg,x,short_hash)}
+    {
+      advance(x);
+    }
+
+    const value_type& dereference()const noexcept
+    {
+      return c->elements[pos*N+n].value();
+    }
+
+    bool equal(const equal_iterator& x)const noexcept
+    {
+      return pg==x.pg&&(!pg||n==x.n);
+    }
+
+    void increment(){advance(*px);}
+
+    template<typename K>
+    void advance(const K& x)
+    {
+      for(;;){
+        while(mask){
+          n=(std::size_t)unchecked_countr_zero((unsigned int)mask);
+          mask&=mask-1;
+          if constexpr(!is_direct_key_group<group_type>::value){
+            if(BOOST_UNLIKELY(
+              !c->pred(x,c->elements[pos*N+n].value())))continue;
+          }
+          px=&extract_key(dereference());
+          return;
+        }
+        if(pg->is_not_overflowed(short_hash)||!pb.next(c->groups.size())){
+          pg=nullptr;
+          return;
+        }
+        pos=pb.get();
+        pg=c->groups.data()+pos;
+        mask=c->match(pg,x,short_hash);
+      }
+    }
+
+    const foa_unordered_rc_set *c=nullptr;
+    const element_key_type     *px=nullptr;
+    std::size_t                short_hash=0;
+    prober                     pb{0};
+    std::size_t                pos=0;
+    const group_type           *pg=nullptr;
+    int                        mask=0;
+    std::size_t                n=0;
+  };
+
+  static constexpr int max_freeze_growth_steps=4;
+
+  /* returned by freeze() */
+  class frozen_view
+  {
+  public:
+    size_type size()const noexcept{return c->size();}
+    iterator  begin()const noexcept{return c->begin();}
+    iterator  end()const noexcept{return {};}
+
+    /* inspects at most two groups */
+    template<typename Key>
+    BOOST_FORCEINLINE iterator find(const Key& x)const
+    {
+      return c->frozen_find(x);
+    }
+
+  private:
+    friend class foa_unordered_rc_set;
+
+    frozen_view(const foa_unordered_rc_set* c):c{c}{}
+
+    const foa_unordered_rc_set *c;
+  };
+
   foa_unordered_rc_set()
   {
     groups.back().set_sentinel();
@@ -929,21 +1364,120 @@ public:
     this->rehash(n);
   }
 
-  foa_unordered_rc_set(const foa_unordered_rc_set&)=default;
-  foa_unordered_rc_set(foa_unordered_rc_set&&)=default;
+  /* Storage is obtained from al exclusively and only index arithmetic is
+   * used on it, so allocators with fancy pointers (e.g. those of
+   * Boost.Interprocess) allow for the container to be placed in shared
+   * memory or mapped files.
+   */
+  explicit foa_unordered_rc_set(const Allocator& al):al{al}
+  {
+    groups.back().set_sentinel();
+  }
 
-  ~foa_unordered_rc_set()
+  /* no rehashing: groups are copied verbatim, and so are elements if
+   * trivially copyable (otherwise they're copy constructed in place)
+   */
+  foa_unordered_rc_set(const foa_unordered_rc_set& x):
+    foa_unordered_rc_set{
+      x,alloc_traits::select_on_container_copy_construction(x.al)}{}
+
+  foa_unordered_rc_set(const foa_unordered_rc_set& x,const Allocator& al_):
+    h{x.h},pred{x.pred},al{al_},
+    mlf{x.mlf},size_{x.size_},group_size_index{x.group_size_index},
+    groups{x.groups,al},
+    elements{
+      std::is_trivially_copyable_v<T>?
+        element_vector(x.elements,al):element_vector(x.elements.size(),al)},
+    summary{x.summary},
+    ml{x.ml}
+  {
+    if constexpr(!std::is_trivially_copyable_v<T>)copy_elements_from(x);
+  }
+
+  /* x is left empty with the minimal table we start with */
+  foa_unordered_rc_set(foa_unordered_rc_set&& x):
+    h{x.h},pred{x.pred},al{x.al},mlf{x.mlf}
+  {
+    groups.back().set_sentinel();
+    swap_storage(x);
+  }
+
+  ~foa_unordered_rc_set(){destroy_elements();}
+
+  foa_unordered_rc_set& operator=(const foa_unordered_rc_set& x)
   {
-    if(!groups.empty()){
-     for(auto first=begin(),last=end();first!=last;)erase(first++);
+    constexpr bool pocca=
+      alloc_traits::propagate_on_container_copy_assignment::value;
+
+    if(this==&x)return *this;
+    if constexpr(std::is_trivially_copyable_v<T>){
+      if(groups.size()==x.groups.size()&&(!pocca||al==x.al)){
+        /* reuse capacity */
+        h=x.h;
+        pred=x.pred;
+        mlf=x.mlf;
+        size_=x.size_;
+        groups=x.groups;
+        elements=x.elements;
+        summary=x.summary;
+        ml=x.ml;
+        return *this;
+      }
+    }
+    foa_unordered_rc_set tmp{x,pocca?x.al:al};
+    clear();
+    if constexpr(pocca)std::swap(al,tmp.al);
+    h=x.h;
+    pred=x.pred;
+    mlf=x.mlf;
+    swap_storage(tmp);
+    return *this;
+  }
+
+  /* x is left empty (with our former capacity if storage changes hands) */
+  foa_unordered_rc_set& operator=(foa_unordered_rc_set&& x)
+  {
+    constexpr bool pocma=
+      alloc_traits::propagate_on_container_move_assignment::value;
+
+    if(this==&x)return *this;
+    if constexpr(!pocma){
+      if(al!=x.al){ /* storage can't be taken over, move element-wise */
+        clear();
+        h=x.h;
+        pred=x.pred;
+        mlf=x.mlf;
+        ml=max_load();
+        reserve(x.size_);
+        for(std::size_t pos=0,last=x.groups.size();pos!=last;++pos){
+          auto pe=x.elements.data()+pos*N;
+          auto mask=x.groups[pos].match_really_occupied();
+          while(mask){
+            auto n=unchecked_countr_zero((unsigned int)mask);
+            unchecked_insert(std::move(pe[n].value()));
+            mask&=mask-1;
+          }
+        }
+        x.clear();
+        return *this;
+      }
     }
+    clear();
+    if constexpr(pocma)std::swap(al,x.al);
+    h=x.h;
+    pred=x.pred;
+    mlf=x.mlf;
+    swap_storage(x);
+    return *this;
   }
   
   const_iterator begin()const noexcept
   {
-    auto pg=groups.data();
-    const_iterator it{pg,0,elements.data()};
-    if(pg&&!(pg->match_really_occupied()&0x1u))++it;
+    if(groups.empty())return end();
+    auto pos=summary.first();
+    auto pg=groups.data()+pos;
+    const_iterator it{pg,0,elements.data()+pos*N,cursor()};
+    if(!(pg->match_really_occupied()&0x1u))++it;
     return it;
   }
   
@@ -954,6 +1488,24 @@ public:
 
   size_type size()const noexcept{return size_;};
 
+  allocator_type get_allocator()const noexcept{return al;}
+
+  /* keeps capacity: only occupied slots are destroyed (none for trivially
+   * destructible T) and then all control words are reset in bulk
+   */
+  void clear()noexcept
+  {
+    if(groups.empty())return;
+    destroy_elements();
+    std::fill(groups.begin(),groups.end(),group_type{});
+    groups.back().set_sentinel();
+    summary.clear(groups.size());
+    size_=0;
+  }
+
+  /* returns iterator for equivalent_keys, std::pair<iterator,bool>
+   * otherwise
+   */
   BOOST_FORCEINLINE auto insert(const T& x){return insert_impl(x);}
   BOOST_FORCEINLINE auto insert(T&& x){return insert_impl(std::move(x));}
 
@@ -961,18 +1513,33 @@ public:
   {
     destroy_element(pos.pe->data());
     group_type::reset(pos.pc);
+    summary.update(
+      pos.group(),static_cast<std::size_t>(pos.group()-groups.data()));
     --size_;
   }
 
+  /* erases all equivalent elements under equivalent_keys */
   template<typename Key>
   size_type erase(const Key& x)
   {
-    auto it=find(x);
-    if(it!=end()){
-      erase(it);
-      return 1;
+    if constexpr(multi){
+      auto hash=h(x);
+      return visit_all_impl(
+        x,
+        position_for(hash_split_policy::long_hash(hash)),
+        hash_split_policy::short_hash(hash),
+        [this](const group_type* pg,std::size_t n,const element_type* pe){
+          erase_impl(pg,n,pe);
+        });
+    }
+    else{
+      auto it=find(x);
+      if(it!=end()){
+        erase(it);
+        return 1;
+      }
+      else return 0;
     }
-    else return 0;
   }
   
   template<typename Key>
@@ -988,14 +1555,281 @@ public:
       hash_split_policy::short_hash(hash));
   }
 
+  /* f is invoked on every equivalent element under equivalent_keys */
+  template<typename Key,typename F>
+  BOOST_FORCEINLINE size_type visit(const Key& x,F f)const
+  {
+    auto hash=h(x);
+    auto g=[&](const group_type*,std::size_t,const element_type* pe){
+      f(pe->value());
+    };
+    if constexpr(multi){
+      return visit_all_impl(
+        x,
+        position_for(hash_split_policy::long_hash(hash)),
+        hash_split_policy::short_hash(hash),
+        g);
+    }
+    else{
+      return visit_impl(
+        x,
+        position_for(hash_split_policy::long_hash(hash)),
+        hash_split_policy::short_hash(hash),
+        g);
+    }
+  }
+
+  template<typename Key>
+  size_type count(const Key& x)const
+  {
+    return visit(x,[](const value_type&){});
+  }
+
+  template<typename Key>
+  std::pair<equal_iterator<Key>,equal_iterator<Key>>
+  equal_range(const Key& x)const
+  {
+    auto hash=h(x);
+    return {
+      equal_iterator<Key>{
+        this,x,
+        position_for(hash_split_policy::long_hash(hash)),
+        hash_split_policy::short_hash(hash)},
+      {}
+    };
+  }
+
+  /* returns true if x was inserted, otherwise f is invoked on the
+   * equivalent element
+   */
+  template<typename F>
+  BOOST_FORCEINLINE bool insert_or_visit(const T& x,F f)
+  {
+    static_assert(!multi,"unique_keys only");
+    return insert_or_visit_impl(x,f);
+  }
+
+  template<typename F>
+  BOOST_FORCEINLINE bool insert_or_visit(T&& x,F f)
+  {
+    static_assert(!multi,"unique_keys only");
+    return insert_or_visit_impl(std::move(x),f);
+  }
+
+  /* maps only: if an element with key k exists, update is invoked on its
+   * mapped value, otherwise {k,init} is inserted; returns true if insertion
+   * took place
+   */
+  template<typename Key,typename Init,typename Update>
+  BOOST_FORCEINLINE bool upsert(const Key& k,Init&& init,Update update)
+  {
+    static_assert(!multi,"unique_keys only");
+    auto hash=h(k);
+    auto long_hash=hash_split_policy::long_hash(hash);
+    auto pos0=position_for(long_hash);
+    auto short_hash=hash_split_policy::short_hash(hash);
+    if(visit_impl(
+      k,pos0,short_hash,
+      [&](const group_type*,std::size_t,const element_type* pe){
+        update(pe->value().second);
+      })){
+      return false;
+    }
+    else if(BOOST_UNLIKELY(size_>=ml)){
+      unchecked_reserve(size_+1);
+      pos0=position_for(long_hash);
+    }
+    unchecked_insert(value_type(k,std::forward<Init>(init)),pos0,short_hash);
+    return true;
+  }
+
+  /* maps only */
+  template<typename Key,typename Delta>
+  BOOST_FORCEINLINE bool add(const Key& k,const Delta& delta)
+  {
+    return upsert(k,delta,[&](auto& v){v+=delta;});
+  }
+
+  /* maps only: moves the elements of x into *this; when an element with
+   * the same key already exists, combine(mapped,std::move(x_mapped)) is
+   * invoked instead. x is left empty.
+   */
+  template<typename Combine>
+  void merge(foa_unordered_rc_set& x,Combine combine)
+  {
+    static_assert(!multi,"unique_keys only");
+    if(this==&x||!x.size_)return;
+    if(!size_&&al==x.al){
+      /* the layout goes along with the hash function it was built with,
+       * while each side keeps its max load factor
+       */
+      std::swap(h,x.h);
+      std::swap(pred,x.pred);
+      std::swap(size_,x.size_);
+      std::swap(group_size_index,x.group_size_index);
+      std::swap(groups,x.groups);
+      std::swap(elements,x.elements);
+      std::swap(summary,x.summary);
+      ml=max_load();
+      x.ml=x.max_load();
+      if(size_>ml)unchecked_reserve(size_);
+      return;
+    }
+
+    if(size_+x.size_>ml)unchecked_reserve(size_+x.size_);
+    for(std::size_t pos=0,last=x.groups.size();pos!=last;++pos){
+      auto pg=x.groups.data()+pos;
+      auto pe=x.elements.data()+pos*N;
+      auto mask=pg->match_really_occupied();
+      while(mask){
+        auto n=unchecked_countr_zero((unsigned int)mask);
+        auto& y=pe[n].value();
+        auto  hash=h(y);
+        auto  pos0=position_for(hash_split_policy::long_hash(hash));
+        auto  short_hash=hash_split_policy::short_hash(hash);
+        if(!visit_impl(
+          extract_key(y),pos0,short_hash,
+          [&](const group_type*,std::size_t,const element_type* p){
+            combine(p->value().second,std::move(y.second));
+          })){
+          /* no capacity check needed, we reserved in advance */
+          unchecked_insert(std::move(y),pos0,short_hash);
+        }
+        x.erase_impl(pg,(std::size_t)n,pe+n);
+        mask&=mask-1;
+      }
+    }
+  }
+
+  /* pr is checked on every equivalent element under equivalent_keys;
+   * returns the number of elements erased
+   */
+  template<typename Key,typename Predicate>
+  size_type erase_if(const Key& x,Predicate pr)
+  {
+    auto      hash=h(x);
+    size_type res=0;
+    auto      f=[&,this](
+      const group_type* pg,std::size_t n,const element_type* pe){
+      if(pr(pe->value())){
+        erase_impl(pg,n,pe);
+        ++res;
+      }
+    };
+    if constexpr(multi){
+      visit_all_impl(
+        x,
+        position_for(hash_split_policy::long_hash(hash)),
+        hash_split_policy::short_hash(hash),
+        f);
+    }
+    else{
+      visit_impl(
+        x,
+        position_for(hash_split_policy::long_hash(hash)),
+        hash_split_policy::short_hash(hash),
+        f);
+    }
+    return res;
+  }
+
+  template<typename F>
+  void for_each(F f)const
+  {
+    for_each_in_groups(0,groups.size(),f);
+  }
+
+#if defined(FXA_UNORDERED_PARALLEL_ALGORITHMS)
+  /* f can be invoked concurrently from several threads */
+  template<
+    typename ExecutionPolicy,typename F,
+    typename=enable_if_execution_policy_t<ExecutionPolicy>
+  >
+  void for_each(ExecutionPolicy&& policy,F f)const
+  {
+    auto num_groups=groups.size(),
+         num_chunks=(num_groups+for_each_chunk_size-1)/for_each_chunk_size;
+    std::for_each(
+      std::forward<ExecutionPolicy>(policy),
+      boost::counting_iterator<std::size_t>(0),
+      boost::counting_iterator<std::size_t>(num_chunks),
+      [&,this](std::size_t chunk){
+        auto first=chunk*for_each_chunk_size,
+             last=(std::min)(first+for_each_chunk_size,num_groups);
+        for_each_in_groups(first,last,f);
+      });
+  }
+#endif
+
   void rehash(std::size_t nb)
   {
     std::size_t n=static_cast<std::size_t>(1.0f+static_cast<float>(nb)*mlf);
     if(n>ml)unchecked_reserve(n);
   }
 
+  void reserve(std::size_t n)
+  {
+    if(n>ml)unchecked_reserve(n);
+  }
+
+  size_type capacity()const noexcept{return groups.size()*N;}
+
+  float load_factor()const noexcept
+  {
+    return static_cast<float>(size_)/static_cast<float>(capacity());
+  }
+
   float max_load_factor()const{return mlf;}
 
+  /* capped at 1, max load always leaves one slot available */
+  void max_load_factor(float z)
+  {
+    if(!(z>0.0f)){
+      throw std::invalid_argument(
+        "foa_unordered_rc_set: invalid max load factor");
+    }
+    if(z>1.0f)z=1.0f;
+    mlf=z;
+    ml=max_load();
+    if(size_>ml)unchecked_reserve(size_);
+  }
+
+  /* For read-only phases: rebuilds the table with the fewest groups such
+   * that every element lies either in its home group or in the next one
+   * of its probe sequence, and returns a view whose find looks into these
+   * two groups only. The view is valid until the container is modified;
+   * load may exceed max_load_factor(), in which case the next insertion
+   * rehashes. Growth is given up on after max_freeze_growth_steps
+   * (roughly doubling the number of groups each time), throwing
+   * std::runtime_error and leaving the container untouched: this only
+   * happens with many elements sharing a hash value, as an ill-behaved
+   * hash function would produce.
+   */
+  frozen_view freeze()
+  {
+    std::vector<std::size_t> hashes;
+    auto                     push_hash=[&,this](const value_type& x){
+      hashes.push_back(h(x));
+    };
+    hashes.reserve(size_);
+    for_each_in_groups(0,groups.size(),push_hash);
+
+    std::vector<std::size_t> quotas;
+    auto                     new_size_index=
+      size_policy::size_index((size_+1+N-1)/N);
+    for(int i=0;!frozen_quotas(hashes,new_size_index,quotas);++i){
+      auto next_size_index=size_policy::size_index(
+        size_policy::size(new_size_index)+1);
+      if(i==max_freeze_growth_steps||next_size_index==new_size_index){
+        throw std::runtime_error(
+          "foa_unordered_rc_set: too many colliding hashes to freeze");
+      }
+      new_size_index=next_size_index;
+    }
+    frozen_rebuild(hashes,new_size_index,quotas);
+    return {this};
+  }
+
 private:
   // used only on unchecked_reserve
   foa_unordered_rc_set(std::size_t n,Allocator al):
@@ -1044,20 +1878,119 @@ private:
     return size_policy::position(hash,group_size_index);
   }
 
+  cursor_type cursor()const
+  {
+    return summary.get_cursor(groups.data());
+  }
+
+  /* allocators travel along with their storage; caller sees to al */
+  void swap_storage(foa_unordered_rc_set& x)noexcept
+  {
+    std::swap(size_,x.size_);
+    std::swap(group_size_index,x.group_size_index);
+    swap_with_allocators(groups,x.groups);
+    swap_with_allocators(elements,x.elements);
+    swap_with_allocators(summary,x.summary);
+    ml=max_load();
+    x.ml=x.max_load();
+  }
+
+  void copy_elements_from(const foa_unordered_rc_set& x)
+  {
+    std::size_t pos=0,last=groups.size();
+    int         mask=0;
+    try{
+      for(;pos!=last;++pos){
+        mask=groups[pos].match_really_occupied();
+        while(mask){
+          auto n=(std::size_t)unchecked_countr_zero((unsigned int)mask);
+          construct_element(
+            x.elements[pos*N+n].value(),elements[pos*N+n].data());
+          mask&=mask-1;
+        }
+      }
+    }
+    catch(...){
+      /* undo all elements up to the one whose construction threw */
+      for(std::size_t i=0;i<=pos&&i!=last;++i){
+        auto m=groups[i].match_really_occupied();
+        if(i==pos)m&=~mask;
+        while(m){
+          auto n=(std::size_t)unchecked_countr_zero((unsigned int)m);
+          destroy_element(elements[i*N+n].data());
+          m&=m-1;
+        }
+      }
+      throw;
+    }
+  }
+
+  void destroy_elements()
+  {
+    if constexpr(!std::is_trivially_destructible_v<T>){
+      for(std::size_t pos=0,last=groups.size();pos!=last;++pos){
+        auto mask=groups[pos].match_really_occupied();
+        while(mask){
+          auto n=(std::size_t)unchecked_countr_zero((unsigned int)mask);
+          destroy_element(elements[pos*N+n].data());
+          mask&=mask-1;
+        }
+      }
+    }
+  }
+
+  template<typename F>
+  void for_each_in_groups(std::size_t first,std::size_t last,F& f)const
+  {
+    for(auto pos=first;pos!=last;++pos){
+      auto pg=groups.data()+pos;
+      auto pe=elements.data()+pos*N;
+      auto mask=pg->match_really_occupied();
+      while(mask){
+        auto n=unchecked_countr_zero((unsigned int)mask);
+        f(pe[n].value());
+        mask&=mask-1;
+      }
+    }
+  }
+
   template<typename Key>
 //#if defined(BOOST_MSVC)
   BOOST_FORCEINLINE 
 //#endif
   iterator find_impl(
     const Key& x,std::size_t pos0,std::size_t short_hash)const
+  {
+    iterator res;
+    visit_impl(
+      x,pos0,short_hash,
+      [&,this](const group_type* pg,std::size_t n,const element_type* pe){
+        res={pg,n,pe,cursor()};
+      });
+    return res;
+  }
+
+  /* f is invoked on the matching element, if any; returns whether found */
+  template<typename Key,typename F>
+  BOOST_FORCEINLINE bool visit_impl(
+    const Key& x,std::size_t pos0,std::size_t short_hash,F&& f)const
   {    
-     prober pb(pos0);
+    auto   pgroups=groups.data();
+    auto   pelements=elements.data();
+    auto   num_groups=groups.size();
+    prober pb(pos0);
     do{
       auto pos=pb.get();
-      auto pg=groups.data()+pos;
-      auto mask=pg->match(short_hash);
-      if(mask){
-        auto pe=elements.data()+pos*N;
+      auto pg=pgroups+pos;
+      if constexpr(is_direct_key_group<group_type>::value){
+        if(auto mask=pg->match_key(x)){
+          auto n=(std::size_t)unchecked_countr_zero((unsigned int)mask);
+          f(pg,n,pelements+pos*N+n);
+          return true;
+        }
+      }
+      else if(auto mask=pg->match(short_hash)){
+        auto pe=pelements+pos*N;
 #if BOOST_ARCH_ARM
         prefetch_elements(pe);
 #else
@@ -1066,21 +1999,233 @@ private:
         do{
           auto n=unchecked_countr_zero((unsigned int)mask);
           if(BOOST_LIKELY(pred(x,pe[n].value()))){
-            return {pg,(std::size_t)(n),pe+n};
+            f(pg,(std::size_t)(n),pe+n);
+            return true;
           }
           mask&=mask-1;
         }while(mask);
       }
       if(BOOST_LIKELY(pg->is_not_overflowed(short_hash))){
-        return end();
+        return false;
+      }
+    }
+    while(BOOST_LIKELY(pb.next(num_groups)));
+    return false;
+  }
+
+  template<typename Key>
+  BOOST_FORCEINLINE int match(
+    const group_type* pg,const Key& x,std::size_t short_hash)const
+  {
+    if constexpr(is_direct_key_group<group_type>::value){
+      return pg->match_key(x);
+    }
+    else return pg->match(short_hash);
+  }
+
+  /* f is invoked on all matching elements; returns their number */
+  template<typename Key,typename F>
+  BOOST_FORCEINLINE size_type visit_all_impl(
+    const Key& x,std::size_t pos0,std::size_t short_hash,F&& f)const
+  {
+    size_type res=0;
+    prober    pb(pos0);
+    do{
+      auto pos=pb.get();
+      auto pg=groups.data()+pos;
+      if(auto mask=match(pg,x,short_hash)){
+        auto pe=elements.data()+pos*N;
+        prefetch(pe,std::false_type{});
+        do{
+          auto n=unchecked_countr_zero((unsigned int)mask);
+          if constexpr(is_direct_key_group<group_type>::value){
+            f(pg,(std::size_t)(n),pe+n);
+            ++res;
+          }
+          else if(BOOST_LIKELY(pred(x,pe[n].value()))){
+            f(pg,(std::size_t)(n),pe+n);
+            ++res;
+          }
+          mask&=mask-1;
+        }while(mask);
       }
+      if(BOOST_LIKELY(pg->is_not_overflowed(short_hash)))break;
     }
     while(BOOST_LIKELY(pb.next(groups.size())));
+    return res;
+  }
+
+  static std::size_t second_position(std::size_t pos,std::size_t size)
+  {
+    prober pb(pos);
+    pb.next(size);
+    return pb.get();
+  }
+
+  template<typename Key>
+  BOOST_FORCEINLINE iterator frozen_find(const Key& x)const
+  {
+    auto hash=h(x);
+    auto pos=position_for(hash_split_policy::long_hash(hash));
+    auto short_hash=hash_split_policy::short_hash(hash);
+    for(int i=0;i<2;++i){
+      auto pg=groups.data()+pos;
+      if(auto mask=match(pg,x,short_hash)){
+        auto pe=elements.data()+pos*N;
+        do{
+          auto n=unchecked_countr_zero((unsigned int)mask);
+          if constexpr(is_direct_key_group<group_type>::value){
+            return {pg,(std::size_t)n,pe+n,cursor()};
+          }
+          else if(BOOST_LIKELY(pred(x,pe[n].value()))){
+            return {pg,(std::size_t)n,pe+n,cursor()};
+          }
+          mask&=mask-1;
+        }while(mask);
+      }
+      if(BOOST_LIKELY(pg->is_not_overflowed(short_hash)))break;
+      pos=second_position(pos,groups.size());
+    }
     return end();
   }
 
+  /* Computes, for a table of size_index, how many elements of each home
+   * group stay there (quotas), the rest going to the next group of their
+   * probe sequence. Elements carried over from the previous group have
+   * no other choice and so take precedence; as the last group carries
+   * over into second_position(last), we iterate until the carry stabilizes.
+   * Returns false if some element can't be placed.
+   */
+  bool frozen_quotas(
+    const std::vector<std::size_t>& hashes,std::size_t size_index,
+    std::vector<std::size_t>& quotas)const
+  {
+    auto size=size_policy::size(size_index);
+    if(size*N-1<hashes.size())return false;
+
+    std::vector<std::size_t> counts(size,0);
+    for(auto hash:hashes){
+      ++counts[size_policy::position(
+        hash_split_policy::long_hash(hash),size_index)];
+    }
+
+    auto        wrap_pos=second_position(size-1,size);
+    std::size_t wrap_in=0;
+    quotas.assign(size,0);
+    for(int pass=0;pass<16;++pass){
+      std::size_t carry=0;
+      for(std::size_t pos=0;pos<size;++pos){
+        std::size_t capacity=pos==size-1?N-1:N, /* sentinel */
+                    in=carry+(pos==wrap_pos?wrap_in:0);
+        if(in>capacity)return false;
+        quotas[pos]=(std::min)(capacity-in,counts[pos]);
+        carry=counts[pos]-quotas[pos];
+      }
+      if(carry==wrap_in)return true;
+      wrap_in=carry;
+    }
+    return false;
+  }
+
+  void frozen_rebuild(
+    const std::vector<std::size_t>& hashes,std::size_t size_index,
+    std::vector<std::size_t>& quotas)
+  {
+    auto           size=size_policy::size(size_index);
+    group_vector   new_groups(size,al);
+    element_vector new_elements(size*N,al);
+    summary_type   new_summary(size,al);
+    std::size_t    num_tx=0;
+    new_groups.back().set_sentinel();
+    try{
+      for(std::size_t pos=0,last=groups.size();pos!=last;++pos){
+        auto pg=groups.data()+pos;
+        auto pe=elements.data()+pos*N;
+        auto mask=pg->match_really_occupied();
+        while(mask){
+          auto n=unchecked_countr_zero((unsigned int)mask);
+          auto& x=pe[(std::size_t)n];
+          auto hash=hashes[num_tx];
+          auto short_hash=hash_split_policy::short_hash(hash);
+          auto home=size_policy::position(
+            hash_split_policy::long_hash(hash),size_index);
+          auto new_pos=home;
+          if(quotas[home])--quotas[home];
+          else{
+            new_groups[home].mark_overflow(short_hash);
+            new_pos=second_position(home,size);
+          }
+          auto new_pg=new_groups.data()+new_pos;
+          auto new_n=unchecked_countr_zero(
+            (unsigned int)new_pg->match_available());
+          auto new_pe=new_elements.data()+new_pos*N+new_n;
+          construct_element(std::move(x.value()),new_pe->data());
+          new_pg->set(new_n,short_hash);
+          if constexpr(is_direct_key_group<group_type>::value){
+            new_pg->set_key(new_n,extract_key(new_pe->value()));
+          }
+          new_summary.set(new_pos);
+          destroy_element(x.data());
+          ++num_tx;
+          mask&=mask-1;
+        }
+      }
+    }
+    catch(...){
+      /* as in unchecked_reserve, elements moved so far are lost */
+      size_-=num_tx;
+      if(num_tx){
+        for(auto pg=groups.data();;++pg){
+          auto mask=pg->match_really_occupied();
+          while(mask){
+            auto n=unchecked_countr_zero((unsigned int)mask);
+            pg->reset(n);
+            if(!(--num_tx))goto end;
+            mask&=mask-1;
+          }
+        }
+      }
+    end:
+      for(std::size_t pos=0;pos!=size;++pos){
+        auto mask=new_groups[pos].match_really_occupied();
+        while(mask){
+          auto n=unchecked_countr_zero((unsigned int)mask);
+          destroy_element(new_elements[pos*N+n].data());
+          mask&=mask-1;
+        }
+      }
+      clean_without_destruction(new_elements);
+      throw;
+    }
+    group_size_index=size_index;
+    clean_without_destruction(groups);
+    groups=std::move(new_groups);
+    clean_without_destruction(elements);
+    elements=std::move(new_elements);
+    summary=std::move(new_summary);
+    ml=max_load();
+  }
+
+  void erase_impl(const group_type* pg,std::size_t n,const element_type* pe)
+  {
+    destroy_element(const_cast<element_type*>(pe)->data());
+    const_cast<group_type*>(pg)->reset(n);
+    summary.update(pg,static_cast<std::size_t>(pg-groups.data()));
+    --size_;
+  }
+
+  template<typename Value>
+  BOOST_FORCEINLINE auto insert_impl(Value&& x)
+  {
+    if constexpr(multi){
+      if(BOOST_UNLIKELY(size_>=ml))unchecked_reserve(size_+1);
+      return unchecked_insert(std::forward<Value>(x));
+    }
+    else return insert_unique_impl(std::forward<Value>(x));
+  }
+
   template<typename Value>
-  BOOST_FORCEINLINE std::pair<iterator,bool> insert_impl(Value&& x)
+  BOOST_FORCEINLINE std::pair<iterator,bool> insert_unique_impl(Value&& x)
   {
     auto hash=h(x);
     auto long_hash=hash_split_policy::long_hash(hash);
@@ -1101,6 +2246,28 @@ private:
     };
   }
 
+  template<typename Value,typename F>
+  BOOST_FORCEINLINE bool insert_or_visit_impl(Value&& x,F& f)
+  {
+    auto hash=h(x);
+    auto long_hash=hash_split_policy::long_hash(hash);
+    auto pos0=position_for(long_hash);
+    auto short_hash=hash_split_policy::short_hash(hash);
+    if(visit_impl(
+      extract_key(x),pos0,short_hash,
+      [&](const group_type*,std::size_t,const element_type* pe){
+        f(pe->value());
+      })){
+      return false;
+    }
+    else if(BOOST_UNLIKELY(size_>=ml)){
+      unchecked_reserve(size_+1);
+      pos0=position_for(long_hash);
+    }
+    unchecked_insert(std::forward<Value>(x),pos0,short_hash);
+    return true;
+  }
+
   BOOST_NOINLINE void unchecked_reserve(size_type new_size)
   {
     std::size_t nc =(std::numeric_limits<std::size_t>::max)();
@@ -1144,6 +2311,7 @@ private:
     groups=std::move(new_container.groups);
     clean_without_destruction(elements);
     elements=std::move(new_container.elements);
+    summary=std::move(new_container.summary);
     ml=max_load();
   }
 
@@ -1166,8 +2334,12 @@ private:
     auto pe=elements.data()+pos*N+n;
     construct_element(std::forward<Value>(x),pe->data());
     pg->set(n,short_hash);
+    if constexpr(is_direct_key_group<group_type>::value){
+      pg->set_key(n,extract_key(pe->value()));
+    }
+    summary.set(pos);
     ++size_;
-    return {pg,std::size_t(n),pe};
+    return {pg,std::size_t(n),pe,cursor()};
   }
 
   std::pair<std::size_t,std::size_t>
@@ -1198,14 +2370,9 @@ private:
   float                                    mlf=0.875;
   std::size_t                              size_=0;
   std::size_t                              group_size_index=size_policy::size_index(size_/N+1);
-  std::vector<
-    group_type,
-    typename alloc_traits::
-      template rebind_alloc<group_type>>   groups{size_policy::size(group_size_index),al};
-  std::vector<
-    element_type,
-    typename alloc_traits::
-      template rebind_alloc<element_type>> elements{groups.size()*N,al};
+  group_vector                             groups{size_policy::size(group_size_index),al};
+  element_vector                           elements{groups.size()*N,al};
+  summary_type                             summary{groups.size(),al};
   size_type                                ml=max_load();
 };
 
@@ -1216,12 +2383,44 @@ template<
   typename Group=group15,
   typename SizePolicy=pow2_size,
   typename Prober=pow2_prober,
-  typename HashSplitPolicy=shift_hash<0>
+  typename HashSplitPolicy=shift_hash<0>,
+  typename IterationPolicy=plain_iteration
 >
 using foa_unordered_rc_map=foa_unordered_rc_set<
   map_value_adaptor<Key,Value>,
   map_hash_adaptor<Hash>,map_pred_adaptor<Pred>,
-  Allocator,Group,SizePolicy,Prober,HashSplitPolicy
+  Allocator,Group,SizePolicy,Prober,HashSplitPolicy,IterationPolicy
+>;
+
+template<
+  typename T,typename Hash=boost::hash<T>,typename Pred=std::equal_to<T>,
+  typename Allocator=std::allocator<T>,
+  typename Group=group15,
+  typename SizePolicy=pow2_size,
+  typename Prober=pow2_prober,
+  typename HashSplitPolicy=shift_hash<0>,
+  typename IterationPolicy=plain_iteration
+>
+using foa_unordered_rc_multiset=foa_unordered_rc_set<
+  T,Hash,Pred,Allocator,Group,SizePolicy,Prober,HashSplitPolicy,
+  IterationPolicy,equivalent_keys
+>;
+
+template<
+  typename Key,typename Value,
+  typename Hash=boost::hash<Key>,typename Pred=std::equal_to<Key>,
+  typename Allocator=std::allocator<map_value_adaptor<Key,Value>>,
+  typename Group=group15,
+  typename SizePolicy=pow2_size,
+  typename Prober=pow2_prober,
+  typename HashSplitPolicy=shift_hash<0>,
+  typename IterationPolicy=plain_iteration
+>
+using foa_unordered_rc_multimap=foa_unordered_rc_set<
+  map_value_adaptor<Key,Value>,
+  map_hash_adaptor<Hash>,map_pred_adaptor<Pred>,
+  Allocator,Group,SizePolicy,Prober,HashSplitPolicy,IterationPolicy,
+  equivalent_keys
 >;
 
 } // namespace rc
@@ -1230,5 +2429,7 @@ using foa_unordered_rc_map=foa_unordered_rc_set<
 
 using fxa_unordered::rc::foa_unordered_rc_set;
 using fxa_unordered::rc::foa_unordered_rc_map;
+using fxa_unordered::rc::foa_unordered_rc_multiset;
+using fxa_unordered::rc::foa_unordered_rc_multimap;
 
 #endif
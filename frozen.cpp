@@ -0,0 +1,167 @@
+// Copyright 2022 Joaquin M Lopez Munoz.
+// Distributed under the Boost Software License, Version 1.0.
+// https://www.boost.org/LICENSE_1_0.txt
+
+#include <boost/algorithm/minmax_element.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "container_defs.hpp"
+#include "foa_rc_frozen.hpp"
+
+using namespace std::chrono_literals;
+
+static void print_time( std::chrono::steady_clock::time_point & t1, char const* label, std::uint64_t s, std::size_t size )
+{
+    auto t2 = std::chrono::steady_clock::now();
+
+    std::cout << label << ": " << ( t2 - t1 ) / 1ms << " ms (s=" << s << ", size=" << size << ")\n";
+
+    t1 = t2;
+}
+
+// N string keys inserted into foa_unordered_rc_map, which is then exported
+// to a file and mapped back as a frozen_rc_map: lookups (half of them
+// successful) are run on both
+
+constexpr unsigned N = 2'000'000;
+constexpr int K = 10;
+
+static std::vector<std::string> indices;
+
+static std::string make_random_index( unsigned x )
+{
+    char buffer[ 64 ];
+    std::snprintf( buffer, sizeof(buffer), "pfx_%0*d_%u_sfx", x % 8 + 1, 0, x );
+
+    return buffer;
+}
+
+static void init_indices()
+{
+    indices.reserve( N*2+1 );
+    indices.push_back( make_random_index( 0 ) );
+
+    boost::detail::splitmix64 rng;
+
+    for( unsigned i = 1; i <= N*2; ++i )
+    {
+        indices.push_back( make_random_index( static_cast<std::uint32_t>( rng() ) ) );
+    }
+}
+
+static char const * const image_path = "fxa_unordered_frozen_benchmark.bin";
+
+using rc_map = foa_unordered_rc_map<std::string, std::uint64_t, boost::hash<std::string_view>>;
+using frozen_map = fxa_unordered::rc::frozen_rc_map<std::uint64_t>;
+
+static std::uint64_t const * find( rc_map const& map, std::string const& k )
+{
+    auto it = map.find( k );
+    return it != map.end()? &it->second: nullptr;
+}
+
+static std::uint64_t const * find( frozen_map const& map, std::string const& k )
+{
+    return map.find( k );
+}
+
+template<class Map> void BOOST_NOINLINE test_lookup( Map& map, std::chrono::steady_clock::time_point & t1 )
+{
+    std::uint64_t s = 0;
+
+    for( int j = 0; j < K; ++j )
+    {
+        for( unsigned i = 1; i <= N * 2; ++i )
+        {
+            if( auto p = find( map, indices[ i ] ) ) s += *p;
+        }
+    }
+
+    print_time( t1, "Random lookup",  s, map.size() );
+
+    std::cout << std::endl;
+}
+
+//
+
+struct record
+{
+    std::string label_;
+    long long time_;
+};
+
+static std::vector<record> times;
+
+template<class Map> void BOOST_NOINLINE test( char const* label, Map& map )
+{
+    std::cout << label << ":\n\n";
+
+    auto t0 = std::chrono::steady_clock::now();
+    auto t1 = t0;
+
+    test_lookup( map, t1 );
+
+    times.push_back( { label, ( t1 - t0 ) / 1ms } );
+}
+
+int main()
+{
+    init_indices();
+
+    rc_map map;
+
+    {
+        auto t1 = std::chrono::steady_clock::now();
+
+        for( unsigned i = 1; i <= N; ++i )
+        {
+            map.insert( { indices[ i ], i } );
+        }
+
+        print_time( t1, "Build foa_unordered_rc_map",  0, map.size() );
+
+        frozen_map::write( map, image_path );
+
+        print_time( t1, "Write image",  0, map.size() );
+
+        std::cout << std::endl;
+    }
+
+    test( "foa_unordered_rc_map", map );
+
+    {
+        auto t1 = std::chrono::steady_clock::now();
+
+        frozen_map fmap( image_path );
+
+        print_time( t1, "Map image",  0, fmap.size() );
+
+        std::cout << std::endl;
+
+        test( "frozen_rc_map", fmap );
+    }
+
+    std::remove( image_path );
+
+    std::cout << "---\n\n";
+
+    int label_witdh = 0;
+    for( auto const& x: times ) label_witdh = (std::max)((int)( x.label_ + ": " ).size(), label_witdh);
+
+    for (auto const& x : times)
+    {
+        std::cout << std::setw(label_witdh) << (x.label_ + ": ") << std::setw( 5 ) << x.time_ << " ms\n";
+    }
+
+    auto [pmint, pmaxt] = boost::minmax_element(
+        times.begin(), times.end(), [](const record& x, const record& y){ return x.time_< y.time_; });
+
+    std::cout << "\n" << std::setw( 28 ) << "Time(worst)/time(best): " << (float)(pmaxt->time_) / pmint->time_ << "\n\n";
+}
@@ -15,12 +15,25 @@
 #include <cstddef>
 #include <cstdint>
 #include <iterator>
+#include <type_traits>
 #include "fastrange.h"
 
 #if defined(_MSC_VER)
 # include <intrin.h>
 #endif
 
+/* libstdc++ may require linking against TBB merely for including
+ * <execution>: define FXA_UNORDERED_DISABLE_PARALLEL_ALGORITHMS to opt out.
+ */
+#if !defined(FXA_UNORDERED_DISABLE_PARALLEL_ALGORITHMS)&&defined(__has_include)
+# if __has_include(<execution>)
+#  include <execution>
+#  if defined(__cpp_lib_execution)
+#   define FXA_UNORDERED_PARALLEL_ALGORITHMS
+#  endif
+# endif
+#endif
+
 #if defined(__SSE2__) || \
     defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
 # define FXA_UNORDERED_SSE2
@@ -405,6 +418,15 @@ struct xm_hash
   }
 };
 
+#if defined(FXA_UNORDERED_PARALLEL_ALGORITHMS)
+template<typename ExecutionPolicy>
+using enable_if_execution_policy_t=std::enable_if_t<
+  std::is_execution_policy_v<std::remove_cvref_t<ExecutionPolicy>>>;
+#endif
+
+/* number of groups visited per task in parallel traversals */
+constexpr std::size_t for_each_chunk_size=256;
+
 template<class Key,class Value>
 struct map_value_adaptor
 {
@@ -52,6 +52,18 @@ constexpr inline void set(uint64_t& x,unsigned pos,unsigned n)
   x&=~(simasks[n]<<pos);
 }
 
+constexpr inline unsigned get(uint64_t x,unsigned pos)
+{
+  assert(pos<16);
+
+  x>>=pos;
+  return unsigned(
+    (x&1)|
+    ((x>>15)&2)|
+    ((x>>30)&4)|
+    ((x>>45)&8));
+}
+
 constexpr inline uint64_t mmask(uint64_t n)
 {
   uint64_t m=0;
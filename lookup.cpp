@@ -0,0 +1,189 @@
+// Copyright 2022 Joaquin M Lopez Munoz.
+// Distributed under the Boost Software License, Version 1.0.
+// https://www.boost.org/LICENSE_1_0.txt
+
+#include <boost/algorithm/minmax_element.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <span>
+#include <vector>
+#include "container_defs.hpp"
+
+using namespace std::chrono_literals;
+
+static void print_time( std::chrono::steady_clock::time_point & t1, char const* label, std::uint64_t s, std::size_t size )
+{
+    auto t2 = std::chrono::steady_clock::now();
+
+    std::cout << label << ": " << ( t2 - t1 ) / 1ms << " ms (s=" << s << ", size=" << size << ")\n";
+
+    t1 = t2;
+}
+
+// Successful and unsuccessful lookups timed separately on a map of N
+// random keys, well beyond cache size; maps providing find_many are also
+// timed looking up the same keys in chunks of M through it
+
+constexpr unsigned N = 8'000'000;
+constexpr int K = 3;
+constexpr unsigned M = 1024;
+
+static std::vector< std::uint64_t > indices;
+
+static void init_indices()
+{
+    indices.push_back( 0 );
+
+    boost::detail::splitmix64 rng;
+
+    for( unsigned i = 1; i <= N*2; ++i )
+    {
+        indices.push_back( rng() );
+    }
+}
+
+template<class Map> void BOOST_NOINLINE test_insert( Map& map, std::chrono::steady_clock::time_point & t1 )
+{
+    for( unsigned i = 1; i <= N; ++i )
+    {
+        map.insert( { indices[ i ], i } );
+    }
+
+    print_time( t1, "Random insert",  0, map.size() );
+
+    std::cout << std::endl;
+}
+
+template<class Map> void BOOST_NOINLINE test_lookup( Map& map, std::chrono::steady_clock::time_point & t1 )
+{
+    std::uint64_t s;
+
+    s = 0;
+
+    for( int j = 0; j < K; ++j )
+    {
+        for( unsigned i = 1; i <= N; ++i )
+        {
+            auto it = map.find( indices[ i ] );
+            if( it != map.end() ) s += it->second;
+        }
+    }
+
+    print_time( t1, "Successful lookup",  s, map.size() );
+
+    s = 0;
+
+    for( int j = 0; j < K; ++j )
+    {
+        for( unsigned i = N + 1; i <= N * 2; ++i )
+        {
+            auto it = map.find( indices[ i ] );
+            if( it != map.end() ) s += it->second;
+        }
+    }
+
+    print_time( t1, "Unsuccessful lookup",  s, map.size() );
+
+    std::cout << std::endl;
+}
+
+template<class Map> void BOOST_NOINLINE test_find_many( Map& map, std::chrono::steady_clock::time_point & t1 )
+{
+    std::vector< typename Map::iterator > its( M );
+    std::uint64_t s;
+
+    auto find_range = [&]( unsigned first, unsigned last )
+    {
+        for( unsigned i = first; i < last; i += M )
+        {
+            auto n = (std::min)( M, last - i );
+            map.find_many( std::span<std::uint64_t const>( &indices[ i ], n ), its.begin() );
+
+            for( unsigned j = 0; j < n; ++j )
+            {
+                if( its[ j ] != map.end() ) s += its[ j ]->second;
+            }
+        }
+    };
+
+    s = 0;
+
+    for( int j = 0; j < K; ++j ) find_range( 1, N + 1 );
+
+    print_time( t1, "Successful find_many",  s, map.size() );
+
+    s = 0;
+
+    for( int j = 0; j < K; ++j ) find_range( N + 1, N * 2 + 1 );
+
+    print_time( t1, "Unsuccessful find_many",  s, map.size() );
+
+    std::cout << std::endl;
+}
+
+//
+
+struct record
+{
+    std::string label_;
+    long long time_;
+};
+
+static std::vector<record> times;
+
+template<template<class...> class Map> void BOOST_NOINLINE test( char const* label )
+{
+    std::cout << label << ":\n\n";
+
+    Map<std::uint64_t, std::uint64_t> map;
+
+    auto t1 = std::chrono::steady_clock::now();
+
+    test_insert( map, t1 );
+
+    auto t0 = t1;
+
+    test_lookup( map, t1 );
+
+    std::cout << "Total lookup: " << ( t1 - t0 ) / 1ms << " ms\n\n";
+
+    times.push_back( { label, ( t1 - t0 ) / 1ms } );
+
+    if constexpr( requires { map.find_many( std::span<std::uint64_t const>(), typename decltype(map)::iterator() ); } )
+    {
+        t0 = t1;
+
+        test_find_many( map, t1 );
+
+        std::cout << "Total find_many: " << ( t1 - t0 ) / 1ms << " ms\n\n";
+
+        times.push_back( { std::string( label ) + " (find_many)", ( t1 - t0 ) / 1ms } );
+    }
+}
+
+int main()
+{
+    init_indices();
+
+    test<boost_unordered_map>( "boost::unordered_map" );
+    test<fca_fmod_unordered_map>( "fca_fmod_unordered_map" );
+    test<fca_fmod_unordered_fingerprinted_map>( "fca_fmod_unordered_fingerprinted_map" );
+
+    std::cout << "---\n\n";
+
+    int label_witdh = 0;
+    for( auto const& x: times ) label_witdh = (std::max)((int)( x.label_ + ": " ).size(), label_witdh);
+
+    for (auto const& x : times)
+    {
+        std::cout << std::setw(label_witdh) << (x.label_ + ": ") << std::setw( 5 ) << x.time_ << " ms\n";
+    }
+
+    auto [pmint, pmaxt] = boost::minmax_element(
+        times.begin(), times.end(), [](const record& x, const record& y){ return x.time_< y.time_; });
+
+    std::cout << "\n" << std::setw( 28 ) << "Time(worst)/time(best): " << (float)(pmaxt->time_) / pmint->time_ << "\n\n";
+}
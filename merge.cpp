@@ -0,0 +1,191 @@
+// Copyright 2021 Peter Dimov.
+// Distributed under the Boost Software License, Version 1.0.
+// https://www.boost.org/LICENSE_1_0.txt
+// Modified by Joaquin M Lopez Munoz: extended for fxa_unordered
+// Copyright 2022 Joaquin M Lopez Munoz.
+// Distributed under the Boost Software License, Version 1.0.
+// https://www.boost.org/LICENSE_1_0.txt
+
+#include <boost/algorithm/minmax_element.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "container_defs.hpp"
+
+using namespace std::chrono_literals;
+
+static void print_time( std::chrono::steady_clock::time_point & t1, char const* label, std::uint64_t s, std::size_t size )
+{
+    auto t2 = std::chrono::steady_clock::now();
+
+    std::cout << label << ": " << ( t2 - t1 ) / 1ms << " ms (s=" << s << ", size=" << size << ")\n";
+
+    t1 = t2;
+}
+
+// S shards of N/4 keys each, consecutive shards overlapping by 75%,
+// as in a parallel aggregation where each thread builds its own map
+
+constexpr unsigned N = 2'000'000;
+constexpr unsigned S = 8;
+constexpr int K = 10;
+
+static std::vector< std::uint64_t > indices;
+
+static void init_indices()
+{
+    indices.push_back( 0 );
+
+    boost::detail::splitmix64 rng;
+
+    for( unsigned i = 1; i <= N*2; ++i )
+    {
+        indices.push_back( rng() );
+    }
+}
+
+template<class Map> void BOOST_NOINLINE build_shards( std::vector<Map>& shards, std::chrono::steady_clock::time_point & t1 )
+{
+    for( unsigned j = 0; j < S; ++j )
+    {
+        auto& map = shards[ j ];
+
+        for( unsigned i = 1; i <= N / 4; ++i )
+        {
+            map.insert( { indices[ j * N / 16 + i ], 1 } );
+        }
+    }
+
+    print_time( t1, "Build shards",  0, shards[ 0 ].size() );
+}
+
+template<class Map> void BOOST_NOINLINE merge_shards( Map& map, std::vector<Map>& shards, bool use_insert, std::chrono::steady_clock::time_point & t1 )
+{
+    for( auto& shard: shards )
+    {
+        if constexpr( requires { shard.merge( shard, []( auto&, auto&& ){} ); } )
+        {
+            if( !use_insert )
+            {
+                map.merge( shard, []( std::uint64_t& x, std::uint64_t&& y ){ x += y; } );
+                continue;
+            }
+        }
+
+        for( const auto& x: shard )
+        {
+            auto r = map.insert( { x.first, x.second } );
+            if( !r.second ) r.first->second += x.second;
+        }
+    }
+
+    std::uint64_t s = 0;
+
+    for( const auto& x: map )
+    {
+        s += x.second;
+    }
+
+    print_time( t1, "Merge shards",  s, map.size() );
+
+    std::cout << std::endl;
+}
+
+//
+
+struct record
+{
+    std::string label_;
+    long long time_;
+    std::size_t bytes_;
+    std::size_t count_;
+};
+
+static std::vector<record> times;
+
+template<template<class...> class Map> void BOOST_NOINLINE test( char const* label, bool use_insert = false )
+{
+    std::cout << label << ":\n\n";
+
+    s_alloc_bytes = 0;
+    s_alloc_count = 0;
+
+    long long tmerge = 0;
+    std::size_t bytes = 0, count = 0;
+
+    for( int k = 0; k < K; ++k )
+    {
+        std::vector< Map<std::uint64_t, std::uint64_t> > shards( S );
+        Map<std::uint64_t, std::uint64_t> map;
+
+        auto t1 = std::chrono::steady_clock::now();
+
+        build_shards( shards, t1 );
+
+        auto t0 = t1;
+
+        merge_shards( map, shards, use_insert, t1 );
+
+        tmerge += ( t1 - t0 ) / 1ms;
+        bytes = s_alloc_bytes;
+        count = s_alloc_count;
+    }
+
+    std::cout << "Memory: " << bytes << " bytes in " << count << " allocations\n\n";
+    std::cout << "Total merge: " << tmerge << " ms\n\n";
+
+    times.push_back( { label, tmerge, bytes, count } );
+}
+
+#if ((SIZE_MAX>>16)>>16)==0
+#define IN_32BIT_ARCHITECTURE
+#endif
+
+int main()
+{
+    init_indices();
+
+    test<std_unordered_map>( "std::unordered_map" );
+    test<boost_unordered_map>( "boost::unordered_map" );
+    test<boost_unordered_flat_map>( "boost_unordered_flat_map" );
+
+    test<foa_mulx_unordered_rc15_map>( "foa_mulx_unordered_rc15_map (insert)", true );
+    test<foa_mulx_unordered_rc15_map>( "foa_mulx_unordered_rc15_map (merge)" );
+
+#if !defined(IN_32BIT_ARCHITECTURE)
+    test<foa_xmx_unordered_rc15_map>( "foa_xmx_unordered_rc15_map (insert)", true );
+    test<foa_xmx_unordered_rc15_map>( "foa_xmx_unordered_rc15_map (merge)" );
+#else
+    test<foa_xmx33_unordered_rc15_map>( "foa_xmx33_unordered_rc15_map (insert)", true );
+    test<foa_xmx33_unordered_rc15_map>( "foa_xmx33_unordered_rc15_map (merge)" );
+#endif
+
+#ifdef HAVE_ABSEIL
+    test<absl_flat_hash_map>( "absl::flat_hash_map" );
+#endif
+
+    std::cout << "---\n\n";
+
+    int label_witdh = 0;
+    for( auto const& x: times ) label_witdh = (std::max)((int)( x.label_ + ": " ).size(), label_witdh);
+
+    auto precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(2);
+
+    for (auto const& x : times)
+    {
+        std::cout << std::setw(label_witdh) << (x.label_ + ": ") <<
+        std::setw( 5 ) << x.time_ << " ms, " <<
+        std::setw( 9 ) << x.bytes_ << " bytes in " << x.count_ << " allocations\n";
+    }
+
+    auto [pmint, pmaxt] = boost::minmax_element(
+        times.begin(), times.end(), [](const record& x, const record& y){ return x.time_< y.time_; });
+
+    std::cout << "\n" << std::setw( 28 ) << "Time(worst)/time(best): " << (float)(pmaxt->time_) / pmint->time_ << "\n";
+
+    std::cout << std::setprecision(precision) << std::defaultfloat<< "\n";
+}
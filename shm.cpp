@@ -0,0 +1,190 @@
+// Copyright 2022 Joaquin M Lopez Munoz.
+// Distributed under the Boost Software License, Version 1.0.
+// https://www.boost.org/LICENSE_1_0.txt
+
+#include <boost/algorithm/minmax_element.hpp>
+#include <boost/interprocess/allocators/allocator.hpp>
+#include <boost/interprocess/managed_shared_memory.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "container_defs.hpp"
+
+using namespace std::chrono_literals;
+
+static void print_time( std::chrono::steady_clock::time_point & t1, char const* label, std::uint64_t s, std::size_t size )
+{
+    auto t2 = std::chrono::steady_clock::now();
+
+    std::cout << label << ": " << ( t2 - t1 ) / 1ms << " ms (s=" << s << ", size=" << size << ")\n";
+
+    t1 = t2;
+}
+
+// Same container with std::allocator (raw pointers) and with a
+// Boost.Interprocess allocator (offset_ptr) placing it in /dev/shm
+
+constexpr unsigned N = 2'000'000;
+constexpr int K = 10;
+
+static std::vector< std::uint64_t > indices;
+
+static void init_indices()
+{
+    indices.push_back( 0 );
+
+    boost::detail::splitmix64 rng;
+
+    for( unsigned i = 1; i <= N*2; ++i )
+    {
+        indices.push_back( rng() );
+    }
+}
+
+namespace bip = boost::interprocess;
+
+static char const * const segment_name = "fxa_unordered_shm_benchmark";
+constexpr std::size_t segment_size = std::size_t( 1 ) << 30;
+
+template<class K, class V>
+using shm_allocator = bip::allocator<
+  fxa_unordered::map_value_adaptor<K, V>,
+  bip::managed_shared_memory::segment_manager>;
+
+template<class K, class V, class A>
+using foa_mulx_unordered_rc15_map_a =
+  foa_unordered_rc_map<
+    K, V, mulx_hash<K>, std::equal_to<K>, A,
+    fxa_unordered::rc::group15>;
+
+template<class K, class V, class A>
+using fca_fmod_unordered_map_a =
+  fca_unordered_map<
+    K, V, boost::hash<K>, std::equal_to<K>, A,
+    fxa_unordered::prime_fmod_size>;
+
+template<class Map> void BOOST_NOINLINE test_insert( Map& map, std::chrono::steady_clock::time_point & t1 )
+{
+    for( unsigned i = 1; i <= N; ++i )
+    {
+        map.insert( { indices[ i ], i } );
+    }
+
+    print_time( t1, "Random insert",  0, map.size() );
+}
+
+template<class Map> void BOOST_NOINLINE test_lookup( Map& map, std::chrono::steady_clock::time_point & t1 )
+{
+    std::uint64_t s = 0;
+
+    for( int j = 0; j < K; ++j )
+    {
+        for( unsigned i = 1; i <= N * 2; ++i )
+        {
+            auto it = map.find( indices[ i ] );
+            if( it != map.end() ) s += it->second;
+        }
+    }
+
+    print_time( t1, "Random lookup",  s, map.size() );
+}
+
+template<class Map> void BOOST_NOINLINE test_erase( Map& map, std::chrono::steady_clock::time_point & t1 )
+{
+    for( unsigned i = 1; i <= N; ++i )
+    {
+        map.erase( indices[ i ] );
+    }
+
+    print_time( t1, "Random erase",  0, map.size() );
+
+    std::cout << std::endl;
+}
+
+//
+
+struct record
+{
+    std::string label_;
+    long long time_;
+};
+
+static std::vector<record> times;
+
+template<class Map, class MakeMap> void BOOST_NOINLINE test_impl( char const* label, MakeMap make_map )
+{
+    std::cout << label << ":\n\n";
+
+    auto t0 = std::chrono::steady_clock::now();
+    auto t1 = t0;
+
+    {
+        auto pm = make_map();
+        auto& map = *pm;
+
+        test_insert( map, t1 );
+        test_lookup( map, t1 );
+        test_erase( map, t1 );
+    }
+
+    auto tN = std::chrono::steady_clock::now();
+    std::cout << "Total: " << ( tN - t0 ) / 1ms << " ms\n\n";
+
+    times.push_back( { label, ( tN - t0 ) / 1ms } );
+}
+
+template<template<class...> class Map> void BOOST_NOINLINE test( std::string const& label )
+{
+    using raw_map = Map<std::uint64_t, std::uint64_t,
+      std::allocator<fxa_unordered::map_value_adaptor<std::uint64_t, std::uint64_t>>>;
+    using shm_map = Map<std::uint64_t, std::uint64_t,
+      shm_allocator<std::uint64_t, std::uint64_t>>;
+
+    test_impl<raw_map>( ( label + " (raw pointers)" ).c_str(), []{
+        return std::make_unique<raw_map>();
+    });
+
+    bip::shared_memory_object::remove( segment_name );
+
+    {
+        bip::managed_shared_memory segment( bip::create_only, segment_name, segment_size );
+
+        test_impl<shm_map>( ( label + " (offset_ptr)" ).c_str(), [&]{
+            auto deleter = [&]( shm_map* p ){ segment.destroy_ptr( p ); };
+
+            return std::unique_ptr<shm_map, decltype( deleter )>(
+                segment.construct<shm_map>( bip::anonymous_instance )(
+                    shm_allocator<std::uint64_t, std::uint64_t>( segment.get_segment_manager() ) ),
+                deleter );
+        });
+    }
+
+    bip::shared_memory_object::remove( segment_name );
+}
+
+int main()
+{
+    init_indices();
+
+    test<foa_mulx_unordered_rc15_map_a>( "foa_mulx_unordered_rc15_map" );
+    test<fca_fmod_unordered_map_a>( "fca_fmod_unordered_map" );
+
+    std::cout << "---\n\n";
+
+    int label_witdh = 0;
+    for( auto const& x: times ) label_witdh = (std::max)((int)( x.label_ + ": " ).size(), label_witdh);
+
+    for (auto const& x : times)
+    {
+        std::cout << std::setw(label_witdh) << (x.label_ + ": ") << std::setw( 5 ) << x.time_ << " ms\n";
+    }
+
+    auto [pmint, pmaxt] = boost::minmax_element(
+        times.begin(), times.end(), [](const record& x, const record& y){ return x.time_< y.time_; });
+
+    std::cout << "\n" << std::setw( 28 ) << "Time(worst)/time(best): " << (float)(pmaxt->time_) / pmint->time_ << "\n\n";
+}
@@ -245,6 +245,7 @@ int main()
     test<fca_unordered_map_fnv1a>( "fca_unordered_map, FNV-1a" );
     test<fca_switch_unordered_map_fnv1a>( "fca_switch_unordered_map, FNV-1a" );
     test<fca_fmod_unordered_map_fnv1a>( "fca_fmod_unordered_map, FNV-1a" );
+    test<fca_fmod_unordered_hcached_map_fnv1a>( "fca_fmod_unordered_hcached_map, FNV-1a" );
     test<fca_frng_unordered_map_fnv1a>( "fca_frng_unordered_map, FNV-1a" );
 
 #if defined(IN_32BIT_ARCHITECTURE)
@@ -253,6 +253,8 @@ int main()
     test<fca_unordered_map_>( "fca_unordered_map" );
     test<fca_switch_unordered_map>( "fca_switch_unordered_map" );
     test<fca_fmod_unordered_map>( "fca_fmod_unordered_map" );
+    test<fca_fmod_unordered_incremental_map>( "fca_fmod_unordered_incremental_map" );
+    test<fca_fmod_unordered_fingerprinted_map>( "fca_fmod_unordered_fingerprinted_map" );
 
     // frng is spectacularly slow for consecutive uint64 insertion
     // (as expected, boost::hash is the identity and position ignores low bits)
@@ -277,6 +279,10 @@ int main()
     test<fca_fmod_unordered_pool_map>( "fca_fmod_unordered_pool_map" );
     test<fca_fmod_unordered_pool_bucket_map>( "fca_fmod_unordered_pool_bucket_map" );
     test<fca_fmod_bcached_unordered_pool_bucket_map>( "fca_fmod_bcached_unordered_pool_bucket_map" );
+    test<fca_fmod_unordered_slab_map>( "fca_fmod_unordered_slab_map" );
+    test<fca_fmod_unordered_slab_bucket_map>( "fca_fmod_unordered_slab_bucket_map" );
+    test<fca_fmod_bcached_unordered_slab_bucket_map>( "fca_fmod_bcached_unordered_slab_bucket_map" );
+    test<fca_fmod_unordered_compact_map>( "fca_fmod_unordered_compact_map" );
     test<fca_fmod_unordered_embedded_map>( "fca_fmod_unordered_embedded_map" );
     test<fca_fmod_unordered_embedded_bucket_map>( "fca_fmod_unordered_embedded_bucket_map" );
     test<fca_fmod_bcached_unordered_embedded_bucket_map>( "fca_fmod_bcached_unordered_embedded_bucket_map" );
@@ -312,6 +318,7 @@ int main()
     // test<foa_absl_unordered_rc15_map>( "foa_absl_unordered_rc15_map" );
     test<foa_mulx_unordered_rc16_map>( "foa_mulx_unordered_rc16_map" );
     test<foa_mulx_unordered_rc15_map>( "foa_mulx_unordered_rc15_map" );
+    test<foa_mulx_unordered_rcdk_map>( "foa_mulx_unordered_rcdk_map" );
 
 #if !defined(IN_32BIT_ARCHITECTURE)
     // test<foa_xmxmx_unordered_rc16_map>( "foa_xmxmx_unordered_rc16_map" );
@@ -363,6 +370,9 @@ int main()
     test<foa_hxm33_unordered_rc15_map>( "foa_hxm33_unordered_rc15_map" );
 #endif
 
+    test<foa_mulx_unordered_dense_map>( "foa_mulx_unordered_dense_map" );
+    test<foa_mulx_unordered_ordered_dense_map>( "foa_mulx_unordered_ordered_dense_map" );
+
 #ifdef HAVE_ANKERL_UNORDERED_DENSE
    test<ankerl_unordered_dense_map>( "ankerl::unordered_dense::map" );
 #endif
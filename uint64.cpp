@@ -13,6 +13,7 @@
 #include <cstdint>
 #include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <vector>
 #include "container_defs.hpp"
 
@@ -206,15 +207,8 @@ struct record
 
 static std::vector<record> times;
 
-template<template<class...> class Map> void BOOST_NOINLINE test( char const* label )
+template<class Map> void BOOST_NOINLINE test_map( std::string const& label, Map& map )
 {
-    std::cout << label << ":\n\n";
-
-    s_alloc_bytes = 0;
-    s_alloc_count = 0;
-    
-    Map<std::uint64_t, std::uint64_t> map;
-
     auto t0 = std::chrono::steady_clock::now();
     auto t1 = t0;
 
@@ -235,6 +229,36 @@ template<template<class...> class Map> void BOOST_NOINLINE test( char const* lab
     times.push_back( rec );
 }
 
+template<template<class...> class Map> void BOOST_NOINLINE test( char const* label )
+{
+    std::cout << label << ":\n\n";
+
+    s_alloc_bytes = 0;
+    s_alloc_count = 0;
+    
+    Map<std::uint64_t, std::uint64_t> map;
+
+    test_map( label, map );
+}
+
+// max load factor set and room for all the insertions reserved up front
+
+template<template<class...> class Map> void BOOST_NOINLINE test_reserved( char const* label, float mlf )
+{
+    std::ostringstream oss;
+    oss << label << " (reserved, mlf=" << mlf << ")";
+    std::cout << oss.str() << ":\n\n";
+
+    s_alloc_bytes = 0;
+    s_alloc_count = 0;
+    
+    Map<std::uint64_t, std::uint64_t> map;
+
+    map.max_load_factor( mlf );
+    map.reserve( 3 * N );
+    test_map( oss.str(), map );
+}
+
 #if ((SIZE_MAX>>16)>>16)==0 
 #define IN_32BIT_ARCHITECTURE
 #endif
@@ -267,6 +291,8 @@ int main()
     test<fca_unordered_map_>( "fca_unordered_map" );
     test<fca_switch_unordered_map>( "fca_switch_unordered_map" );
     test<fca_fmod_unordered_map>( "fca_fmod_unordered_map" );
+    test<fca_fmod_unordered_incremental_map>( "fca_fmod_unordered_incremental_map" );
+    test<fca_fmod_unordered_fingerprinted_map>( "fca_fmod_unordered_fingerprinted_map" );
 
     // frng is spectacularly slow for consecutive uint64 insertion
     // (as expected, boost::hash is the identity and position ignores low bits)
@@ -290,6 +316,10 @@ int main()
     test<fca_fmod_unordered_pool_map>( "fca_fmod_unordered_pool_map" );
     test<fca_fmod_unordered_pool_bucket_map>( "fca_fmod_unordered_pool_bucket_map" );
     test<fca_fmod_bcached_unordered_pool_bucket_map>( "fca_fmod_bcached_unordered_pool_bucket_map" );
+    test<fca_fmod_unordered_slab_map>( "fca_fmod_unordered_slab_map" );
+    test<fca_fmod_unordered_slab_bucket_map>( "fca_fmod_unordered_slab_bucket_map" );
+    test<fca_fmod_bcached_unordered_slab_bucket_map>( "fca_fmod_bcached_unordered_slab_bucket_map" );
+    test<fca_fmod_unordered_compact_map>( "fca_fmod_unordered_compact_map" );
     test<fca_fmod_unordered_embedded_map>( "fca_fmod_unordered_embedded_map" );
     test<fca_fmod_unordered_embedded_bucket_map>( "fca_fmod_unordered_embedded_bucket_map" );
     test<fca_fmod_bcached_unordered_embedded_bucket_map>( "fca_fmod_bcached_unordered_embedded_bucket_map" );
@@ -324,6 +354,7 @@ int main()
     // test<foa_absl_unordered_rc15_map>( "foa_absl_unordered_rc15_map" );
     test<foa_mulx_unordered_rc16_map>( "foa_mulx_unordered_rc16_map" );
     test<foa_mulx_unordered_rc15_map>( "foa_mulx_unordered_rc15_map" );
+    test<foa_mulx_unordered_rcdk_map>( "foa_mulx_unordered_rcdk_map" );
 
 #if !defined(IN_32BIT_ARCHITECTURE)
     // test<foa_xmxmx_unordered_rc16_map>( "foa_xmxmx_unordered_rc16_map" );
@@ -375,6 +406,19 @@ int main()
     test<foa_hxm33_unordered_rc15_map>( "foa_hxm33_unordered_rc15_map" );
 #endif
 
+    test<foa_mulx_unordered_dense_map>( "foa_mulx_unordered_dense_map" );
+    test<foa_mulx_unordered_ordered_dense_map>( "foa_mulx_unordered_ordered_dense_map" );
+
+    for( float mlf: { 0.5f, 1.0f, 2.0f } )
+    {
+        test_reserved<fca_fmod_unordered_map>( "fca_fmod_unordered_map", mlf );
+    }
+
+    for( float mlf: { 0.5f, 0.75f, 0.875f, 1.0f } )
+    {
+        test_reserved<foa_mulx_unordered_rc15_map>( "foa_mulx_unordered_rc15_map", mlf );
+    }
+
 #ifdef HAVE_ABSEIL
     test<absl_node_hash_map>( "absl::node_hash_map" );
     test<absl_flat_hash_map>( "absl::flat_hash_map" );